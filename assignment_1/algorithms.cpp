@@ -1,77 +1,32 @@
 // Sorting algorithms implementation
+// The sorts themselves live in sort_lib.h; this program runs each of them once.
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <functional>
+#include "sort_lib.h"
 
 using namespace std;
 
-// Bubble sort
-void bubbleSort(vector<int>& arr) {
-    int n = arr.size();
-    for (int i = 0; i < n - 1; i++)
-        for (int j = 0; j < n - i - 1; j++)
-            if (arr[j] > arr[j + 1])
-                swap(arr[j], arr[j + 1]);
-}
-
-// Insertion sort
-void insertionSort(vector<int>& arr) {
-    int n = arr.size();
-    for (int i = 1; i < n; i++) {
-        int key = arr[i];
-        int j = i - 1;
-        while (j >= 0 && arr[j] > key) {
-            arr[j + 1] = arr[j];
-            j--;
-        }
-        arr[j + 1] = key;
-    }
-}
+// Subarrays of at most this many elements are finished by a leaf sort (0 = off)
+size_t networkLeaf = 0;
 
-// Merge sort helper
-void merge(vector<int>& arr, int left, int mid, int right) {
-    vector<int> L(arr.begin() + left, arr.begin() + mid + 1);
-    vector<int> R(arr.begin() + mid + 1, arr.begin() + right + 1);
-
-    int i = 0, j = 0, k = left;
-    while (i < L.size() && j < R.size())
-        arr[k++] = (L[i] <= R[j]) ? L[i++] : R[j++];
-    while (i < L.size()) arr[k++] = L[i++];
-    while (j < R.size()) arr[k++] = R[j++];
-}
-
-// Merge sort
-void mergeSort(vector<int>& arr, int left, int right) {
-    if (left >= right) return;
-    int mid = (left + right) / 2;
-    mergeSort(arr, left, mid);
-    mergeSort(arr, mid + 1, right);
-    merge(arr, left, mid, right);
-}
-
-// Quick sort helper
-int partition(vector<int>& arr, int low, int high) {
-    int pivot = arr[high];
-    int i = low - 1;
-    for (int j = low; j < high; j++)
-        if (arr[j] < pivot)
-            swap(arr[++i], arr[j]);
-    swap(arr[i + 1], arr[high]);
-    return i + 1;
-}
-
-// Quick sort
-void quickSort(vector<int>& arr, int low, int high) {
-    if (low < high) {
-        int p = partition(arr, low, high);
-        quickSort(arr, low, p - 1);
-        quickSort(arr, p + 1, high);
-    }
-}
+void bubbleSort(vector<int>& arr)    { sortlib::bubble_sort(arr.begin(), arr.end()); }
+void insertionSort(vector<int>& arr) { sortlib::insertion_sort(arr.begin(), arr.end()); }
+void mergeSort(vector<int>& arr)     { sortlib::merge_sort(arr.begin(), arr.end(), less<>{}, networkLeaf); }
+void quickSort(vector<int>& arr)     { sortlib::quick_sort(arr.begin(), arr.end(), less<>{}, {networkLeaf}); }
 
 
 int main() {
+    vector<int> base = {5, 3, 9, 1, 7, 3, 8, 2, 6, 4, 0, 9};
+    vector<pair<const char*, function<void(vector<int>&)>>> sorts = {
+        {"Bubble", bubbleSort}, {"Insertion", insertionSort}, {"Merge", mergeSort}, {"Quick", quickSort}};
+
+    for (auto& [name, sort] : sorts) {
+        vector<int> arr = base;
+        sort(arr);
+        cout << name << ": " << (is_sorted(arr.begin(), arr.end()) ? "sorted" : "NOT sorted") << endl;
+    }
     cout << "Algorithms file compiled successfully!" << endl;
     return 0;
 }
-
@@ -1,150 +1,136 @@
 #include <iostream>
 #include <vector>
-#include <chrono>
 #include <random>
 #include <algorithm>
 #include <iomanip>
+#include <string>
+#include "sort_lib.h"
+#include "radix_sort.h"
+#include "../common/bench.h"
+#include "../common/input_gen.h"
 
 using namespace std;
 
 long long pivotCount = 0;
 
+// Partitions of at most this many elements go to a sorting network (0 = off)
+size_t networkLeaf = 0;
 
-// Single-pivot Quick Sort
-int partitionSingle(vector<int>& arr, int low, int high) {
-    pivotCount++;
-    int pivot = arr[high];
-    int i = low - 1;
-    for (int j = low; j < high; j++)
-        if (arr[j] < pivot)
-            swap(arr[++i], arr[j]);
-    swap(arr[i + 1], arr[high]);
-    return i + 1;
-}
 
-void quickSortSingle(vector<int>& arr, int low, int high) {
-    if (low < high) {
-        int p = partitionSingle(arr, low, high);
-        quickSortSingle(arr, low, p - 1);
-        quickSortSingle(arr, p + 1, high);
-    }
+// Single-, dual- and triple-pivot Quick Sort (sort_lib.h)
+void quickSortSingle(vector<int>& arr) {
+    sortlib::quick_sort(arr.begin(), arr.end(), less<>{}, {networkLeaf, &pivotCount});
 }
 
-
-// Dual-pivot Quick Sort
-void quickSortDual(vector<int>& arr, int low, int high) {
-    if (low >= high) return;
-    pivotCount += 2;
-    if (arr[low] > arr[high]) swap(arr[low], arr[high]);
-    int pivot1 = arr[low];
-    int pivot2 = arr[high];
-
-    int lt = low + 1, gt = high - 1, i = lt;
-    while (i <= gt) {
-        if (arr[i] < pivot1) swap(arr[i++], arr[lt++]);
-        else if (arr[i] > pivot2) swap(arr[i], arr[gt--]);
-        else i++;
-    }
-    swap(arr[low], arr[--lt]);
-    swap(arr[high], arr[++gt]);
-
-    quickSortDual(arr, low, lt - 1);
-    quickSortDual(arr, lt + 1, gt - 1);
-    quickSortDual(arr, gt + 1, high);
-}
-
-
-// Triple-pivot Quick Sort
-void quickSortTriple(vector<int>& arr, int low, int high) {
-    if (low >= high) return;
-    pivotCount += 3;
-    int mid = low + (high - low) / 2;
-    vector<pair<int,int>> piv = {{arr[low], low}, {arr[mid], mid}, {arr[high], high}};
-    sort(piv.begin(), piv.end());
-    swap(arr[low], arr[piv[0].second]);
-    swap(arr[mid], arr[piv[1].second]);
-    swap(arr[high], arr[piv[2].second]);
-
-    int p1 = arr[low], p2 = arr[mid], p3 = arr[high];
-    vector<int> left, middle, right;
-    for (int i = low + 1; i < high; i++) {
-        if (arr[i] < p1) left.push_back(arr[i]);
-        else if (arr[i] < p2) middle.push_back(arr[i]);
-        else if (arr[i] < p3) right.push_back(arr[i]);
-        else middle.push_back(arr[i]);
-    }
-
-    int idx = low;
-    for (int x : left) arr[idx++] = x;
-    arr[idx++] = p1;
-    for (int x : middle) arr[idx++] = x;
-    arr[idx++] = p2;
-    for (int x : right) arr[idx++] = x;
-    arr[idx++] = p3;
-
-    if (!left.empty()) quickSortTriple(arr, low, low + left.size() - 1);
-    if (!middle.empty()) quickSortTriple(arr, low + left.size() + 1, low + left.size() + middle.size() - 1);
-    if (!right.empty()) quickSortTriple(arr, low + left.size() + middle.size() + 2, high - 1);
+void quickSortDual(vector<int>& arr) {
+    sortlib::quick_sort_dual(arr.begin(), arr.end(), less<>{}, {networkLeaf, &pivotCount});
 }
 
-
-// Generate random array
-vector<int> generateArray(int n) {
-    vector<int> arr(n);
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dist(1, 1'000'000);
-    for (int& x : arr) x = dist(gen);
-    return arr;
+void quickSortTriple(vector<int>& arr) {
+    sortlib::quick_sort_triple(arr.begin(), arr.end(), less<>{}, {networkLeaf, &pivotCount});
 }
 
 
-// Benchmark wrappers
-double benchmarkSingle(vector<int> arr) {
-    pivotCount = 0;
-    auto start = chrono::high_resolution_clock::now();
-    quickSortSingle(arr, 0, arr.size() - 1);
-    auto end = chrono::high_resolution_clock::now();
-    return chrono::duration<double>(end - start).count();
+// Seeded input; an antiqsort input is aimed at sortFn with the current networkLeaf.
+// The adversary sorts indices with its own comparator, so its leaves are
+// insertion sorted, not the int network of the timed run: the input targets
+// the partitioning and the leaf size, not the network itself.
+vector<int> generateArray(inputgen::Dist d, size_t n, unsigned long long seed, void (*sortFn)(vector<int>&)) {
+    auto target = [sortFn](vector<int>& idx, auto less) {
+        sortlib::Options opt{networkLeaf, nullptr};
+        if (sortFn == quickSortSingle) sortlib::quick_sort(idx.begin(), idx.end(), less, opt);
+        else if (sortFn == quickSortDual) sortlib::quick_sort_dual(idx.begin(), idx.end(), less, opt);
+        else sortlib::quick_sort_triple(idx.begin(), idx.end(), less, opt);
+    };
+    return inputgen::generate(d, n, seed, target);
 }
 
-double benchmarkDual(vector<int> arr) {
-    pivotCount = 0;
-    auto start = chrono::high_resolution_clock::now();
-    quickSortDual(arr, 0, arr.size() - 1);
-    auto end = chrono::high_resolution_clock::now();
-    return chrono::duration<double>(end - start).count();
-}
 
-double benchmarkTriple(vector<int> arr) {
-    pivotCount = 0;
-    auto start = chrono::high_resolution_clock::now();
-    quickSortTriple(arr, 0, arr.size() - 1);
-    auto end = chrono::high_resolution_clock::now();
-    return chrono::duration<double>(end - start).count();
+// Benchmark wrapper: median time over fresh copies of arr, pivots of the last run as a metric
+double benchmark(bench::Suite& suite, const string& name, const string& dist,
+                 void (*sortFn)(vector<int>&), const vector<int>& arr) {
+    string param = (networkLeaf ? "leaf=" + to_string(networkLeaf) + ";" : "") + "dist=" + dist;
+    auto& r = suite.run({name, arr.size(), param},
+                        [&] { pivotCount = 0; return arr; },
+                        sortFn);
+    if (pivotCount) r.metric("pivots", pivotCount);
+    return r.stats.median;
 }
 
-int main() {
-    vector<int> sizes = {1000,5000,10000,20000,30000,40000,50000,60000,70000,80000,90000,100000};
-
-
-    cout << setw(8) << "Size"
-         << setw(16) << "SingleTime"
-         << setw(16) << "DualTime"
-         << setw(16) << "TripleTime" << endl;
-
-    for (int n : sizes) {
-        vector<int> arr = generateArray(n);
-
-        double t1 = benchmarkSingle(arr);
-        double t2 = benchmarkDual(arr);
-        double t3 = benchmarkTriple(arr);
-
-        cout << setw(8) << n
-             << setw(16) << fixed << setprecision(6) << t1
-             << setw(16) << fixed << setprecision(6) << t2
-             << setw(16) << fixed << setprecision(6) << t3 << endl;
+void lsdRadix(vector<int>& arr) { radix::lsd_sort<11>(arr); }
+void msdRadix(vector<int>& arr) { radix::msd_sort(arr); }
+
+int main(int argc, char** argv) {
+    bench::Suite suite("algorithmsv5", bench::parse_args(argc, argv));
+    // --dist LIST: input distributions (default all, see input_gen.h)
+    auto dists = inputgen::parse_args(argc, argv);
+    // optional argument: largest size to run (default 100M)
+    size_t maxN = argc > 1 ? stoull(argv[1]) : 100'000'000;
+    const unsigned long long seed = suite.config().seed;
+    vector<size_t> sizes = {1000,5000,10000,20000,30000,40000,50000,60000,70000,80000,90000,100000,
+                            1'000'000,10'000'000,100'000'000};
+
+
+    const size_t leafSize = 32;
+    // structured inputs can make a quicksort quadratic: past this size they only run the radix sorts ("-")
+    const size_t structuredQuickMaxN = 20000;
+    // building an antiqsort input runs std::sort with a stateful comparator (same cap as test_algorithms)
+    const size_t antiqsortMaxN = 1'000'000;
+
+    for (auto d : dists) {
+        const string dist = inputgen::name(d);
+        cout << "Distribution: " << dist << endl;
+        cout << setw(8) << "Size"
+             << setw(16) << "SingleTime"
+             << setw(16) << "DualTime"
+             << setw(16) << "TripleTime"
+             << setw(16) << "SingleNet"
+             << setw(16) << "DualNet"
+             << setw(16) << "TripleNet"
+             << setw(16) << "LSDRadix"
+             << setw(16) << "MSDRadix" << endl;
+
+        for (size_t n : sizes) {
+            if (n > maxN) break;
+            if (d == inputgen::Dist::AntiQsort && n > antiqsortMaxN) break;
+            bool quick = d == inputgen::Dist::Random || n <= structuredQuickMaxN;
+            vector<int> arr = inputgen::generate(d, n, seed);
+
+            // each quicksort gets its own antiqsort input; other distributions share arr
+            auto time = [&](const string& name, void (*sortFn)(vector<int>&)) {
+                if (d != inputgen::Dist::AntiQsort) return benchmark(suite, name, dist, sortFn, arr);
+                return benchmark(suite, name, dist, sortFn, generateArray(d, n, seed, sortFn));
+            };
+
+            double t[6] = {-1, -1, -1, -1, -1, -1};
+            if (quick) {
+                networkLeaf = 0;
+                t[0] = time("quick_single", quickSortSingle);
+                t[1] = time("quick_dual", quickSortDual);
+                t[2] = time("quick_triple", quickSortTriple);
+
+                // same inputs, partitions <= leafSize finished by the sorting network
+                networkLeaf = leafSize;
+                t[3] = time("quick_single", quickSortSingle);
+                t[4] = time("quick_dual", quickSortDual);
+                t[5] = time("quick_triple", quickSortTriple);
+            }
+
+            networkLeaf = 0;
+            double r1 = benchmark(suite, "lsd_radix", dist, lsdRadix, arr);
+            double r2 = benchmark(suite, "msd_radix", dist, msdRadix, arr);
+
+            cout << setw(8) << n;
+            for (double x : t) {
+                if (x < 0) cout << setw(16) << "-";
+                else cout << setw(16) << fixed << setprecision(6) << x;
+            }
+            cout << setw(16) << fixed << setprecision(6) << r1
+                 << setw(16) << fixed << setprecision(6) << r2 << endl;
+        }
+        cout << endl;
     }
 
+    suite.write();
     return 0;
 }
@@ -0,0 +1,102 @@
+// Blocking queue with a fixed capacity, for handing work between pipeline stages
+//
+// push() blocks while the queue is full and pop() while it is empty; close()
+// wakes everyone and makes pop() return false once the queue is drained.
+// stats() reports the time-weighted mean and maximum occupancy and how long
+// producers and consumers spent waiting, which shows the slower side.
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+struct QueueStats {
+    std::size_t capacity = 0, items = 0, max_occupancy = 0;
+    double mean_occupancy = 0;   // averaged over the queue's lifetime
+    double push_wait_s = 0;      // producers blocked on a full queue
+    double pop_wait_s = 0;       // consumers blocked on an empty queue
+};
+
+template <class T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t capacity) : capacity_(capacity ? capacity : 1) {}
+
+    // Returns false if the queue was closed
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (items_.size() >= capacity_ && !closed_) {
+            auto start = clock::now();
+            notFull_.wait(lock, [&] { return items_.size() < capacity_ || closed_; });
+            pushWait_ += seconds(clock::now() - start);
+        }
+        if (closed_) return false;
+        account();
+        items_.push_back(std::move(item));
+        ++pushed_;
+        if (items_.size() > maxOccupancy_) maxOccupancy_ = items_.size();
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    // Returns false once the queue is closed and empty
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (items_.empty() && !closed_) {
+            auto start = clock::now();
+            notEmpty_.wait(lock, [&] { return !items_.empty() || closed_; });
+            popWait_ += seconds(clock::now() - start);
+        }
+        if (items_.empty()) return false;
+        account();
+        item = std::move(items_.front());
+        items_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        account();
+        closed_ = true;
+        notFull_.notify_all();
+        notEmpty_.notify_all();
+    }
+
+    QueueStats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        QueueStats s;
+        s.capacity = capacity_;
+        s.items = pushed_;
+        s.max_occupancy = maxOccupancy_;
+        double lifetime = seconds(last_ - created_);
+        s.mean_occupancy = lifetime > 0 ? area_ / lifetime : 0;
+        s.push_wait_s = pushWait_;
+        s.pop_wait_s = popWait_;
+        return s;
+    }
+
+private:
+    using clock = std::chrono::steady_clock;
+    static double seconds(clock::duration d) { return std::chrono::duration<double>(d).count(); }
+
+    // integrates occupancy over time up to now; called with the lock held
+    void account() {
+        auto now = clock::now();
+        area_ += items_.size() * seconds(now - last_);
+        last_ = now;
+    }
+
+    const std::size_t capacity_;
+    mutable std::mutex mutex_;
+    std::condition_variable notFull_, notEmpty_;
+    std::deque<T> items_;
+    bool closed_ = false;
+
+    clock::time_point created_ = clock::now(), last_ = created_;
+    double area_ = 0, pushWait_ = 0, popWait_ = 0;
+    std::size_t pushed_ = 0, maxOccupancy_ = 0;
+};
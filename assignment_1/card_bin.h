@@ -0,0 +1,354 @@
+// Binary snapshot of a card dump
+//
+//   header   64 bytes: magic "CARDBIN", version, record size, row count, flags,
+//            network count, checksum, offset of the records, size and
+//            modification time of the CSV the snapshot was made from
+//   networks 32 bytes per issuing network name, NUL padded
+//   records  24 bytes per row (CardRecord), in file order
+//
+// A file flagged kSortedByKey stores its rows in stable (year, month, PIN)
+// order; kReordered marks one whose rows were sorted on write, so they are no
+// longer in the CSV's row order. An optional sidecar "<file>.idx" holds that order as a uint32
+// permutation for files that are not stored sorted. Both are memory-mapped,
+// so opening costs O(1); verify() checks the checksum, which covers the header
+// (checksum field zeroed) and everything after it, in one pass. Values are
+// stored in host byte order.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CARDS_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define CARDS_HAVE_MMAP 0
+#endif
+
+#include "card_columns.h"
+
+namespace cards {
+
+constexpr std::uint32_t kBinVersion = 2;
+constexpr std::uint32_t kSortedByKey = 1;  // header flags
+constexpr std::uint32_t kReordered = 2;
+constexpr std::size_t kNetworkNameSize = 32;
+
+struct BinHeader {
+    char magic[8];                 // "CARDBIN\0"
+    std::uint32_t version;
+    std::uint32_t record_size;
+    std::uint64_t rows;
+    std::uint32_t flags;
+    std::uint32_t network_count;
+    std::uint64_t checksum;        // over the header (this field zeroed), the network table and the records
+    std::uint64_t records_offset;
+    std::uint64_t source_size;     // of the CSV this was converted from, 0 if unknown
+    std::int64_t source_mtime;     // its last write time, in file clock ticks
+};
+static_assert(sizeof(BinHeader) == 64, "BinHeader layout");
+
+struct CardRecord {
+    std::uint64_t card;            // known card digits as a number
+    std::uint32_t key;             // (year * 13 + month) * 10000 + PIN
+    std::uint16_t year;
+    std::uint16_t pin;             // CardColumns::kNoPin = empty
+    std::array<char, 4> verification;
+    std::uint8_t month;
+    std::uint8_t card_len;
+    std::uint8_t network;
+    std::uint8_t unused;
+};
+static_assert(sizeof(CardRecord) == 24, "CardRecord layout");
+
+struct IndexHeader {
+    char magic[8];                 // "CARDIDX\0"
+    std::uint32_t version;
+    std::uint32_t unused;
+    std::uint64_t rows;
+    std::uint64_t bin_checksum;    // checksum of the .bin this index belongs to
+};
+static_assert(sizeof(IndexHeader) == 32, "IndexHeader layout");
+
+// 64-bit multiplicative hash over whole words, FNV-style
+inline std::uint64_t checksum(const unsigned char* p, std::size_t n, std::uint64_t h = 0xCBF29CE484222325ull) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        std::uint64_t w;
+        std::memcpy(&w, p + i, 8);
+        h = (h ^ w) * 0x100000001B3ull;
+        h ^= h >> 29;
+    }
+    for (; i < n; ++i) h = (h ^ p[i]) * 0x100000001B3ull;
+    return h;
+}
+
+// Checksum stored in the header: the header with its checksum field zeroed, then the body
+inline std::uint64_t file_checksum(const BinHeader& header, const unsigned char* body, std::size_t n) {
+    BinHeader h = header;
+    h.checksum = 0;
+    return checksum(body, n, checksum(reinterpret_cast<const unsigned char*>(&h), sizeof(h)));
+}
+
+// Identifies the CSV a snapshot was made from; a regenerated CSV gets a new stamp
+struct SourceStamp {
+    std::uint64_t size = 0;
+    std::int64_t mtime = 0;
+};
+
+inline SourceStamp source_stamp(const std::string& path) {
+    std::error_code ec;
+    SourceStamp s;
+    auto size = std::filesystem::file_size(path, ec);
+    if (ec) return {};
+    auto time = std::filesystem::last_write_time(path, ec);
+    if (ec) return {};
+    s.size = size;
+    s.mtime = std::int64_t(time.time_since_epoch().count());
+    return s;
+}
+
+// ----------------- Memory mapping -----------------
+// Read-only view of a whole file: mmap where available, otherwise read into memory
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+#if CARDS_HAVE_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) { ::close(fd); return false; }
+        size_ = std::size_t(st.st_size);
+        if (size_ > 0) {
+            void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) { ::close(fd); size_ = 0; return false; }
+            data_ = static_cast<const unsigned char*>(p);
+        }
+        ::close(fd);
+        return true;
+#else
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) return false;
+        buf_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        data_ = buf_.data();
+        size_ = buf_.size();
+        return true;
+#endif
+    }
+
+    void close() {
+#if CARDS_HAVE_MMAP
+        if (data_) munmap(const_cast<unsigned char*>(data_), size_);
+#else
+        buf_.clear();
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const unsigned char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    const unsigned char* data_ = nullptr;
+    std::size_t size_ = 0;
+#if !CARDS_HAVE_MMAP
+    std::vector<unsigned char> buf_;
+#endif
+};
+
+// ----------------- Reading -----------------
+class MappedDump {
+public:
+    // Maps the file and checks the header; the records are not read
+    bool open(const std::string& path) {
+        path_ = path;
+        if (!file_.open(path)) return fail("cannot open");
+        if (file_.size() < sizeof(BinHeader)) return fail("too short for a header");
+        std::memcpy(&header_, file_.data(), sizeof(BinHeader));
+        if (std::memcmp(header_.magic, "CARDBIN", 8) != 0) return fail("not a card dump snapshot");
+        if (header_.version != kBinVersion) return fail("unsupported version " + std::to_string(header_.version));
+        if (header_.record_size != sizeof(CardRecord)) return fail("unexpected record size");
+        if (header_.records_offset != sizeof(BinHeader) + header_.network_count * kNetworkNameSize ||
+            file_.size() != header_.records_offset + header_.rows * sizeof(CardRecord))
+            return fail("truncated or malformed");
+        records_ = reinterpret_cast<const CardRecord*>(file_.data() + header_.records_offset);
+        return true;
+    }
+
+    // One pass over the network table and the records
+    bool verify() const {
+        const unsigned char* body = file_.data() + sizeof(BinHeader);
+        if (file_checksum(header_, body, file_.size() - sizeof(BinHeader)) == header_.checksum) return true;
+        std::cerr << path_ << ": checksum mismatch" << std::endl;
+        return false;
+    }
+
+    // Maps "<file>.idx" if it exists and belongs to this snapshot
+    bool open_index() {
+        std::string path = path_ + ".idx";
+        if (!index_file_.open(path)) return false;
+        IndexHeader h;
+        if (index_file_.size() < sizeof(IndexHeader)) return false;
+        std::memcpy(&h, index_file_.data(), sizeof(h));
+        if (std::memcmp(h.magic, "CARDIDX", 8) != 0 || h.version != kBinVersion || h.rows != header_.rows ||
+            h.bin_checksum != header_.checksum || index_file_.size() != sizeof(h) + h.rows * sizeof(std::uint32_t)) {
+            std::cerr << path << ": stale or malformed index, ignored" << std::endl;
+            index_file_.close();
+            return false;
+        }
+        index_ = reinterpret_cast<const std::uint32_t*>(index_file_.data() + sizeof(IndexHeader));
+        return true;
+    }
+
+    const BinHeader& header() const { return header_; }
+    std::size_t size() const { return std::size_t(header_.rows); }
+    bool sorted() const { return header_.flags & kSortedByKey; }
+    bool reordered() const { return header_.flags & kReordered; }  // not in CSV row order
+    const CardRecord& operator[](std::size_t i) const { return records_[i]; }
+    const std::uint32_t* index() const { return index_; }  // null without a sidecar
+
+    // True if the snapshot was made from the CSV with this stamp
+    bool from_source(const SourceStamp& s) const {
+        return s.size != 0 && header_.source_size == s.size && header_.source_mtime == s.mtime;
+    }
+
+    std::string network(std::size_t id) const {
+        const char* name = reinterpret_cast<const char*>(file_.data() + sizeof(BinHeader) + id * kNetworkNameSize);
+        return std::string(name, std::find(name, name + kNetworkNameSize, '\0'));
+    }
+
+    // Columns in file order, or row i = record order[i]
+    CardColumns to_columns(const std::uint32_t* order = nullptr) const {
+        CardColumns c;
+        for (std::uint32_t id = 0; id < header_.network_count; ++id) c.networks.push_back(network(id));
+        c.resize(size());
+        for (std::size_t i = 0; i < size(); ++i) {
+            const CardRecord& r = records_[order ? order[i] : i];
+            c.card[i] = r.card;
+            c.card_len[i] = r.card_len;
+            c.year[i] = r.year;
+            c.month[i] = r.month;
+            c.verification[i] = r.verification;
+            c.pin[i] = r.pin;
+            c.network[i] = r.network;
+        }
+        return c;
+    }
+
+private:
+    bool fail(const std::string& why) {
+        std::cerr << path_ << ": " << why << std::endl;
+        file_.close();
+        return false;
+    }
+
+    std::string path_;
+    MappedFile file_, index_file_;
+    BinHeader header_{};
+    const CardRecord* records_ = nullptr;
+    const std::uint32_t* index_ = nullptr;
+};
+
+// ----------------- Writing -----------------
+// Writes the dump, in (year, month, PIN) order when sort is set. The sorted
+// flag is also set when the rows already happen to be in that order. source
+// stamps the CSV the dump was read from (see MappedDump::from_source).
+inline bool write_bin(const std::string& path, const CardColumns& c, bool sort = false,
+                      const SourceStamp& source = {}) {
+    for (const auto& name : c.networks)
+        if (name.size() > kNetworkNameSize) {
+            std::cerr << path << ": network name longer than " << kNetworkNameSize << " bytes: " << name << std::endl;
+            return false;
+        }
+    std::vector<std::uint32_t> order;
+    if (sort) order = sort_permutation(c);
+
+    std::vector<unsigned char> body(c.networks.size() * kNetworkNameSize + c.size() * sizeof(CardRecord), 0);
+    for (std::size_t id = 0; id < c.networks.size(); ++id)
+        std::memcpy(&body[id * kNetworkNameSize], c.networks[id].data(),
+                    std::min(c.networks[id].size(), kNetworkNameSize));
+
+    bool inOrder = true, moved = false;
+    std::uint32_t prev = 0;
+    auto* records = reinterpret_cast<CardRecord*>(body.data() + c.networks.size() * kNetworkNameSize);
+    for (std::size_t i = 0; i < c.size(); ++i) {
+        std::size_t j = sort ? order[i] : i;
+        moved |= j != i;
+        CardRecord r{};
+        r.card = c.card[j];
+        r.key = c.key(j);
+        r.year = c.year[j];
+        r.pin = c.pin[j];
+        r.verification = c.verification[j];
+        r.month = c.month[j];
+        r.card_len = c.card_len[j];
+        r.network = c.network[j];
+        std::memcpy(&records[i], &r, sizeof(r));
+        if (r.key < prev) inOrder = false;
+        prev = r.key;
+    }
+
+    BinHeader h{};
+    std::memcpy(h.magic, "CARDBIN", 8);
+    h.version = kBinVersion;
+    h.record_size = sizeof(CardRecord);
+    h.rows = c.size();
+    h.flags = (inOrder ? kSortedByKey : 0) | (moved ? kReordered : 0);
+    h.network_count = std::uint32_t(c.networks.size());
+    h.records_offset = sizeof(BinHeader) + c.networks.size() * kNetworkNameSize;
+    h.source_size = source.size;
+    h.source_mtime = source.mtime;
+    h.checksum = file_checksum(h, body.data(), body.size());
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) { std::cerr << "Error writing " << path << std::endl; return false; }
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char*>(body.data()), std::streamsize(body.size()));
+    return bool(out);
+}
+
+// Writes "<file>.idx": the stable (year, month, PIN) order of a snapshot
+inline bool write_index(const std::string& binPath) {
+    MappedDump d;
+    if (!d.open(binPath)) return false;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> keyed(d.size());
+    for (std::size_t i = 0; i < d.size(); ++i) keyed[i] = {d[i].key, std::uint32_t(i)};
+    radix::lsd_sort<11>(keyed);
+    std::vector<std::uint32_t> order(d.size());
+    for (std::size_t i = 0; i < d.size(); ++i) order[i] = keyed[i].second;
+
+    IndexHeader h{};
+    std::memcpy(h.magic, "CARDIDX", 8);
+    h.version = kBinVersion;
+    h.rows = d.size();
+    h.bin_checksum = d.header().checksum;
+
+    std::string path = binPath + ".idx";
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) { std::cerr << "Error writing " << path << std::endl; return false; }
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char*>(order.data()), std::streamsize(order.size() * sizeof(std::uint32_t)));
+    return bool(out);
+}
+
+} // namespace cards
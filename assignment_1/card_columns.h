@@ -0,0 +1,332 @@
+// Columnar (struct-of-arrays) card dump
+//
+// One contiguous array per field, holding parsed values instead of strings:
+// keying and sorting a dump only stream the expiry and PIN columns (3-5 bytes
+// per row) instead of whole rows of five std::strings. Sorting yields a
+// permutation, which is either applied column by column (apply_permutation)
+// or read through lazily by the merge (merge_linear_index with an order).
+//
+// Values are normalized on load: expiry is written back as MM/YYYY, the PIN as
+// four digits and the card number in the dashed (and masked) dump form. The
+// sort key packs the PIN into four decimal digits, so rows with a longer PIN
+// are rejected when parsed.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "radix_sort.h"
+#include "sort_lib.h"
+
+namespace cards {
+
+struct CardColumns {
+    static constexpr std::uint16_t kNoPin = 0xFFFF;
+    static constexpr int kPinDigits = 4;             // the key below has room for no more
+
+    std::vector<std::uint64_t> card;                 // known card digits as a number
+    std::vector<std::uint8_t> card_len;              // how many digits (0 = none)
+    std::vector<std::uint16_t> year;                 // 0 = no expiry
+    std::vector<std::uint8_t> month;
+    std::vector<std::array<char, 4>> verification;   // up to 4 digits, NUL padded
+    std::vector<std::uint16_t> pin;                  // kNoPin = empty
+    std::vector<std::uint8_t> network;               // index into networks
+    std::vector<std::string> networks;               // names in order of first appearance
+
+    std::size_t size() const { return card.size(); }
+
+    void resize(std::size_t n) {
+        card.resize(n);
+        card_len.resize(n);
+        year.resize(n);
+        month.resize(n);
+        verification.resize(n);
+        pin.resize(n);
+        network.resize(n);
+    }
+
+    // Sort key (year, month, PIN) packed like card_key() in olsen_gang
+    std::uint32_t key(std::size_t i) const {
+        std::uint32_t p = pin[i] == kNoPin ? 0 : pin[i];
+        return (std::uint32_t(year[i]) * 13 + month[i]) * 10000 + p;
+    }
+
+    // Bytes per row held in the columns (the network dictionary is negligible)
+    static constexpr std::size_t row_bytes() {
+        return sizeof(std::uint64_t) + sizeof(std::uint8_t) + sizeof(std::uint16_t) + sizeof(std::uint8_t) +
+               sizeof(std::array<char, 4>) + sizeof(std::uint16_t) + sizeof(std::uint8_t);
+    }
+
+    std::uint8_t network_id(const std::string& name) {
+        for (std::size_t i = 0; i < networks.size(); ++i)
+            if (networks[i] == name) return std::uint8_t(i);
+        networks.push_back(name);
+        return std::uint8_t(networks.size() - 1);
+    }
+};
+
+// ----------------- Parsing -----------------
+namespace detail {
+
+// Digits of s[from, to) as a number; returns the digit count
+inline int parse_digits(std::string_view s, std::size_t from, std::size_t to, std::uint64_t& value) {
+    int len = 0;
+    value = 0;
+    for (std::size_t i = from; i < to && i < s.size(); ++i)
+        if (s[i] >= '0' && s[i] <= '9' && len < 19) {
+            value = value * 10 + std::uint64_t(s[i] - '0');
+            ++len;
+        }
+    return len;
+}
+
+// Splits one CSV line into its five fields, as read_csv does with getline;
+// false if the PIN is longer than CardColumns::kPinDigits
+inline bool parse_row(CardColumns& c, std::size_t i, std::string_view line) {
+    std::size_t b[5], e[5], pos = 0;
+    for (int f = 0; f < 5; ++f) {
+        std::size_t comma = pos < line.size() ? line.find(',', pos) : std::string::npos;
+        b[f] = std::min(pos, line.size());
+        e[f] = comma == std::string::npos ? line.size() : comma;
+        pos = e[f] + 1;
+    }
+
+    std::uint64_t v;
+    c.card_len[i] = std::uint8_t(parse_digits(line, b[0], e[0], v));
+    c.card[i] = v;
+
+    std::size_t slash = line.find('/', b[1]);
+    if (slash < e[1]) {
+        parse_digits(line, b[1], slash, v);
+        c.month[i] = std::uint8_t(v);
+        parse_digits(line, slash + 1, e[1], v);
+        c.year[i] = std::uint16_t(v);
+    } else {
+        c.month[i] = 0;
+        c.year[i] = 0;
+    }
+
+    c.verification[i] = {};
+    for (std::size_t k = b[2], j = 0; k < e[2] && j < 4; ++k) c.verification[i][j++] = line[k];
+
+    int pinLen = parse_digits(line, b[3], e[3], v);
+    if (pinLen > CardColumns::kPinDigits) return false;
+    c.pin[i] = pinLen ? std::uint16_t(v) : CardColumns::kNoPin;
+    c.network[i] = c.network_id(std::string(line.substr(b[4], e[4] - b[4])));
+    return true;
+}
+
+inline std::uint64_t pow10(int e) {
+    static const std::uint64_t table[20] = {
+        1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+        1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+        100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+        1000000000000000000ull, 10000000000000000000ull};
+    return table[e];
+}
+
+// out[i] = col[order[begin + i]], or col[begin + i] without an order
+template <class T>
+void copy_column(std::vector<T>& out, const std::vector<T>& col, const std::uint32_t* order, std::size_t begin) {
+    if (!order) {
+        std::copy(col.begin() + begin, col.begin() + begin + out.size(), out.begin());
+        return;
+    }
+    for (std::size_t i = 0; i < out.size(); ++i) out[i] = col[order[begin + i]];
+}
+
+inline char* put_digits(char* p, std::uint64_t v, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        p[i] = char('0' + v % 10);
+        v /= 10;
+    }
+    return p + width;
+}
+
+// dst row i = src row j (network ids are copied as they are)
+inline void copy_row(CardColumns& dst, std::size_t i, const CardColumns& src, std::size_t j) {
+    dst.card[i] = src.card[j];
+    dst.card_len[i] = src.card_len[j];
+    dst.year[i] = src.year[j];
+    dst.month[i] = src.month[j];
+    dst.verification[i] = src.verification[j];
+    dst.pin[i] = src.pin[j];
+    dst.network[i] = src.network[j];
+}
+
+} // namespace detail
+
+// Empty if the file is missing or has a row with a PIN over kPinDigits digits
+inline CardColumns read_columns(const std::string& path) {
+    CardColumns c;
+    std::ifstream file(path);
+    if (!file.is_open()) { std::cerr << "Error opening " << path << std::endl; return c; }
+
+    std::string line;
+    std::getline(file, line); // skip header
+    std::size_t n = 0;
+    while (std::getline(file, line)) {
+        if (n == c.size()) c.resize(n ? 2 * n : 1024);
+        if (!detail::parse_row(c, n++, line)) {
+            std::cerr << path << ": row " << n << " has a PIN longer than " << CardColumns::kPinDigits
+                      << " digits" << std::endl;
+            return {};
+        }
+    }
+    c.resize(n);
+    return c;
+}
+
+// Appends one row in the CSV schema of the dumps (without the newline)
+inline void append_row(std::string& out, const CardColumns& c, std::size_t i) {
+    char buf[96];
+    char* p = buf;
+    int len = c.card_len[i];
+    if (len) {
+        char d[20];
+        detail::put_digits(d, c.card[i], len);
+        // full numbers are dashed; the half-masked dump forms get their mask back
+        if (len == 16 || len == 12 || len == 4) {
+            const char* src = d;
+            for (int g = 0; g < 4; ++g) {
+                bool masked = (len == 12 && g == 3) || (len == 4 && g < 3);
+                std::memcpy(p, masked ? "****" : src, 4);
+                if (!masked) src += 4;
+                p += 4;
+                *p++ = '-';
+            }
+            --p;
+        } else {
+            std::memcpy(p, d, len);
+            p += len;
+        }
+    }
+    *p++ = ',';
+    if (c.month[i] || c.year[i]) {
+        p = detail::put_digits(p, c.month[i], 2);
+        *p++ = '/';
+        p = detail::put_digits(p, c.year[i], 4);
+    }
+    *p++ = ',';
+    for (char ch : c.verification[i])
+        if (ch) *p++ = ch;
+    *p++ = ',';
+    if (c.pin[i] != CardColumns::kNoPin) p = detail::put_digits(p, c.pin[i], 4);
+    *p++ = ',';
+    out.append(buf, p);
+    out += c.networks[c.network[i]];
+}
+
+inline std::string format_row(const CardColumns& c, std::size_t i) {
+    std::string row;
+    append_row(row, c, i);
+    return row;
+}
+
+inline void write_csv(const std::string& path, const CardColumns& c) {
+    std::ofstream out(path);
+    if (!out.is_open()) { std::cerr << "Error writing " << path << std::endl; return; }
+    out << "Credit Card Number,Expiry Date,Verification Code,PIN,Issueing Network\n";
+    std::string buf;
+    for (std::size_t i = 0; i < c.size(); ++i) {
+        append_row(buf, c, i);
+        buf += '\n';
+        if (buf.size() > (1 << 16)) { out << buf; buf.clear(); }
+    }
+    out << buf;
+}
+
+// ----------------- Sorting -----------------
+// Stable order of the rows by (year, month, PIN); only the key column is built and sorted
+inline std::vector<std::uint32_t> sort_permutation(const CardColumns& c) {
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> keyed(c.size());
+    for (std::size_t i = 0; i < c.size(); ++i) keyed[i] = {c.key(i), std::uint32_t(i)};
+    radix::lsd_sort<11>(keyed);
+    std::vector<std::uint32_t> order(c.size());
+    for (std::size_t i = 0; i < c.size(); ++i) order[i] = keyed[i].second;
+    return order;
+}
+
+// Comparison-sort counterpart of sort_permutation for the log-linear merge
+inline std::vector<std::uint32_t> sort_permutation_loglinear(const CardColumns& c) {
+    std::vector<std::uint32_t> keys(c.size()), order(c.size());
+    for (std::size_t i = 0; i < c.size(); ++i) {
+        keys[i] = c.key(i);
+        order[i] = std::uint32_t(i);
+    }
+    sortlib::merge_sort(order.begin(), order.end(),
+                        [&](std::uint32_t a, std::uint32_t b) { return keys[a] < keys[b]; });
+    return order;
+}
+
+namespace detail {
+
+template <class T>
+void gather(std::vector<T>& col, const std::vector<std::uint32_t>& order) {
+    std::vector<T> out(order.size());
+    for (std::size_t i = 0; i < order.size(); ++i) out[i] = col[order[i]];
+    col.swap(out);
+}
+
+} // namespace detail
+
+// Reorders every column so row i becomes old row order[i], one column at a time
+inline void apply_permutation(CardColumns& c, const std::vector<std::uint32_t>& order) {
+    detail::gather(c.card, order);
+    detail::gather(c.card_len, order);
+    detail::gather(c.year, order);
+    detail::gather(c.month, order);
+    detail::gather(c.verification, order);
+    detail::gather(c.pin, order);
+    detail::gather(c.network, order);
+}
+
+inline void radix_sort_dump2(CardColumns& c) {
+    apply_permutation(c, sort_permutation(c));
+}
+
+// ----------------- Merges -----------------
+// Rows [begin, end) of the merge. Row i joins dump1 row i with dump2 row
+// order2[i] (row i without an order): the card digits are concatenated,
+// everything else comes from dump2.
+inline CardColumns merge_rows(const CardColumns& d1, const CardColumns& d2, const std::uint32_t* order2,
+                              std::size_t begin, std::size_t end) {
+    CardColumns m;
+    m.resize(end - begin);
+    m.networks = d2.networks;
+    for (std::size_t i = begin; i < end; ++i) {
+        std::size_t j = order2 ? order2[i] : i;
+        m.card[i - begin] = d1.card[i] * detail::pow10(d2.card_len[j]) + d2.card[j];
+        m.card_len[i - begin] = std::uint8_t(d1.card_len[i] + d2.card_len[j]);
+    }
+    detail::copy_column(m.year, d2.year, order2, begin);
+    detail::copy_column(m.month, d2.month, order2, begin);
+    detail::copy_column(m.verification, d2.verification, order2, begin);
+    detail::copy_column(m.pin, d2.pin, order2, begin);
+    detail::copy_column(m.network, d2.network, order2, begin);
+    return m;
+}
+
+inline CardColumns merge_linear_index(const CardColumns& d1, const CardColumns& d2,
+                                      const std::vector<std::uint32_t>* order2 = nullptr) {
+    return merge_rows(d1, d2, order2 ? order2->data() : nullptr, 0, d1.size());
+}
+
+// Both dumps comparison-sorted by (year, month, PIN), then joined row by row
+inline CardColumns merge_loglinear(const CardColumns& d1, const CardColumns& d2) {
+    auto order1 = sort_permutation_loglinear(d1);
+    auto order2 = sort_permutation_loglinear(d2);
+    CardColumns s1 = d1;
+    apply_permutation(s1, order1);
+    return merge_linear_index(s1, d2, &order2);
+}
+
+} // namespace cards
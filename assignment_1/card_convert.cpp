@@ -0,0 +1,81 @@
+// Converts card dumps between CSV and the binary snapshot format (card_bin.h)
+//
+//   card_convert csv2bin <in.csv> <out.bin> [--sort] [--index]
+//       --sort   store the rows in (year, month, PIN) order
+//       --index  also write the sidecar <out.bin>.idx with that order
+//   card_convert bin2csv <in.bin> <out.csv> [--sorted]
+//       --sorted write the rows in (year, month, PIN) order
+//   card_convert info <in.bin>
+//       prints the header and verifies the checksum
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include "card_bin.h"
+
+using namespace std;
+
+int usage() {
+    cerr << "usage: card_convert csv2bin <in.csv> <out.bin> [--sort] [--index]\n"
+            "       card_convert bin2csv <in.bin> <out.csv> [--sorted]\n"
+            "       card_convert info <in.bin>\n";
+    return 2;
+}
+
+int csv2bin(const string& in, const string& out, bool sort, bool index) {
+    auto cols = cards::read_columns(in);
+    if (cols.size() == 0) return 1;
+    if (!cards::write_bin(out, cols, sort, cards::source_stamp(in))) return 1;
+    if (index && !cards::write_index(out)) return 1;
+    cout << "Wrote " << cols.size() << " rows to " << out << (index ? " (+ .idx)" : "") << "\n";
+    return 0;
+}
+
+int bin2csv(const string& in, const string& out, bool sorted) {
+    cards::MappedDump d;
+    if (!d.open(in) || !d.verify()) return 1;
+    const uint32_t* order = nullptr;
+    vector<uint32_t> computed;
+    if (sorted && !d.sorted()) {
+        if (d.open_index()) order = d.index();
+        else {
+            computed = cards::sort_permutation(d.to_columns());
+            order = computed.data();
+        }
+    }
+    cards::write_csv(out, d.to_columns(order));
+    cout << "Wrote " << d.size() << " rows to " << out << "\n";
+    return 0;
+}
+
+int info(const string& in) {
+    cards::MappedDump d;
+    if (!d.open(in)) return 1;
+    auto start = chrono::steady_clock::now();
+    bool ok = d.verify();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    const auto& h = d.header();
+    cout << in << ": version " << h.version << ", " << h.rows << " rows of " << h.record_size << " bytes, "
+         << h.network_count << " networks, " << (d.sorted() ? "sorted" : "unsorted")
+         << (d.reordered() ? " (reordered from the CSV)" : "")
+         << ", index " << (d.open_index() ? "present" : "absent")
+         << ", source CSV " << (h.source_size ? to_string(h.source_size) + " bytes" : "unknown")
+         << ", checksum " << (ok ? "ok" : "BAD") << " (" << secs << " s)\n";
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    vector<string> pos;
+    bool sort = false, index = false, sorted = false;
+    for (int i = 1; i < argc; ++i) {
+        string a = argv[i];
+        if (a == "--sort") sort = true;
+        else if (a == "--index") index = true;
+        else if (a == "--sorted") sorted = true;
+        else pos.push_back(a);
+    }
+    if (pos.size() == 3 && pos[0] == "csv2bin") return csv2bin(pos[1], pos[2], sort, index);
+    if (pos.size() == 3 && pos[0] == "bin2csv") return bin2csv(pos[1], pos[2], sorted);
+    if (pos.size() == 2 && pos[0] == "info") return info(pos[1]);
+    return usage();
+}
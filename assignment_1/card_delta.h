@@ -0,0 +1,154 @@
+// Incremental merge: apply a delta to an already merged, sorted dump
+//
+// A delta is a list of operations on merged rows, keyed by card number (its
+// digits and its length, so leading zeros count):
+//   A  add the row (existing rows with that card number are replaced)
+//   U  replace the rows with this card number (the key may change)
+//   D  remove the rows with this card number (only the card number is read)
+// read as CSV in the merged schema with a leading "Op" column, or built from a
+// dump1/dump2 pair of new rows (all adds). The last operation on a card wins,
+// and it applies to every base row with that card number.
+//
+// Only the delta is sorted; the result is produced in one linear pass over the
+// base, which keeps it in stable (year, month, PIN) order: added rows go after
+// existing rows with the same key, as if appended and re-sorted.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "card_columns.h"
+
+namespace cards {
+
+struct Delta {
+    CardColumns rows;
+    std::vector<char> ops;  // 'A', 'U' or 'D' per row
+};
+
+struct DeltaStats {
+    std::size_t added = 0, updated = 0, deleted = 0;   // updated/deleted count base rows
+    std::size_t missing = 0;   // U or D for a card that is not in the base (a U is then added)
+};
+
+// Card number identity: the digits and how many there are
+inline std::uint64_t card_id(const CardColumns& c, std::size_t i) { return c.card[i] << 5 | c.card_len[i]; }
+
+inline Delta read_delta(const std::string& path) {
+    Delta d;
+    std::ifstream file(path);
+    if (!file.is_open()) { std::cerr << "Error opening " << path << std::endl; return d; }
+
+    std::string line;
+    std::getline(file, line); // skip header
+    while (std::getline(file, line)) {
+        std::size_t comma = line.find(',');
+        char op = line.empty() ? '?' : line[0];
+        if (comma != 1 || (op != 'A' && op != 'U' && op != 'D')) {
+            std::cerr << path << ": skipping row without an A/U/D op: " << line << std::endl;
+            continue;
+        }
+        std::size_t i = d.ops.size();
+        d.rows.resize(i + 1);
+        if (!detail::parse_row(d.rows, i, line.substr(2))) {
+            std::cerr << path << ": skipping row with a PIN longer than " << CardColumns::kPinDigits
+                      << " digits: " << line << std::endl;
+            d.rows.resize(i);
+            continue;
+        }
+        d.ops.push_back(op);
+    }
+    return d;
+}
+
+// New rows given as a dump pair: merged like the full dumps, then added
+inline Delta delta_from_dumps(const CardColumns& dump1, const CardColumns& dump2) {
+    Delta d;
+    auto order = sort_permutation(dump2);
+    d.rows = merge_linear_index(dump1, dump2, &order);
+    d.ops.assign(d.rows.size(), 'A');
+    return d;
+}
+
+inline CardColumns apply_delta(const CardColumns& base, const Delta& delta, DeltaStats* stats = nullptr) {
+    DeltaStats st;
+
+    // last operation per card number wins
+    std::unordered_map<std::uint64_t, std::size_t> last;
+    last.reserve(delta.ops.size() * 2);
+    for (std::size_t j = 0; j < delta.ops.size(); ++j) last[card_id(delta.rows, j)] = j;
+    std::vector<char> found(delta.ops.size(), 0);
+
+    // bit filter in front of the map: most base rows are not in the delta
+    std::size_t filterBits = 1024;
+    while (filterBits < 16 * delta.ops.size()) filterBits *= 2;
+    std::vector<std::uint64_t> filter(filterBits / 64, 0);
+    auto slot = [&](std::uint64_t card) { return (card * 0x9E3779B97F4A7C15ull) >> 20 & (filterBits - 1); };
+    for (std::size_t j = 0; j < delta.ops.size(); ++j) {
+        std::size_t b = slot(card_id(delta.rows, j));
+        filter[b / 64] |= std::uint64_t(1) << (b % 64);
+    }
+
+    // rows to insert, sorted by key
+    CardColumns inserts;
+    for (std::size_t j = 0; j < delta.ops.size(); ++j) {
+        if (last[card_id(delta.rows, j)] != j || delta.ops[j] == 'D') continue;
+        std::size_t k = inserts.size();
+        inserts.resize(k + 1);
+        detail::copy_row(inserts, k, delta.rows, j);
+    }
+    inserts.networks = delta.rows.networks;
+    radix_sort_dump2(inserts);
+
+    // delta network ids in the result's dictionary
+    CardColumns out;
+    out.networks = base.networks;
+    std::vector<std::uint8_t> netMap(inserts.networks.size());
+    for (std::size_t id = 0; id < netMap.size(); ++id) netMap[id] = out.network_id(inserts.networks[id]);
+
+    // one pass: drop every base row whose card the delta touches, insert in key order
+    out.resize(base.size() + inserts.size());
+    std::size_t n = 0, j = 0;
+    for (std::size_t i = 0; i < base.size(); ++i) {
+        std::uint32_t key = base.key(i);
+        while (j < inserts.size() && inserts.key(j) < key) {
+            detail::copy_row(out, n, inserts, j++);
+            out.network[n] = netMap[out.network[n]];
+            ++n;
+        }
+        std::uint64_t id = card_id(base, i);
+        std::size_t b = slot(id);
+        auto it = filter[b / 64] >> (b % 64) & 1 ? last.find(id) : last.end();
+        if (it != last.end()) {
+            (delta.ops[it->second] == 'D' ? st.deleted : st.updated)++;
+            found[it->second] = 1;
+            continue;
+        }
+        detail::copy_row(out, n++, base, i);
+    }
+    while (j < inserts.size()) {
+        detail::copy_row(out, n, inserts, j++);
+        out.network[n] = netMap[out.network[n]];
+        ++n;
+    }
+    out.resize(n);
+
+    // cards not found in the base
+    for (const auto& [id, idx] : last) {
+        if (found[idx]) continue;
+        if (delta.ops[idx] == 'A') ++st.added;
+        else {
+            ++st.missing;
+            if (delta.ops[idx] == 'U') ++st.added;
+        }
+    }
+    if (stats) *stats = st;
+    return out;
+}
+
+} // namespace cards
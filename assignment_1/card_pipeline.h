@@ -0,0 +1,233 @@
+// Staged, concurrent version of the olsen_gang merge
+//
+//   read dump1 -> parse dump1 ----------------------.
+//   read dump2 -> parse dump2 -> sort dump2 ---------+-> merge -> format -> write
+//
+// Every arrow after a read or the merge is a BoundedQueue of text blocks or
+// row chunks, so both dumps are read and parsed at the same time, and merged
+// chunks are formatted and written while later chunks are still merged. The
+// sort needs all of dump2 and the merge all of dump1: those are the two
+// barriers. Each stage records its rows and busy time (time spent working,
+// not waiting on a queue); each queue its occupancy.
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bounded_queue.h"
+#include "card_columns.h"
+
+namespace cards {
+
+struct PipelineOptions {
+    std::size_t block_bytes = 1 << 20;   // read granularity
+    std::size_t chunk_rows = 1 << 16;    // merge/format granularity
+    std::size_t queue_capacity = 4;      // blocks or chunks per queue
+};
+
+struct StageStats {
+    std::string name;
+    std::size_t rows = 0;
+    double busy_s = 0;
+};
+
+struct PipelineReport {
+    std::size_t rows = 0;
+    double wall_s = 0;
+    std::vector<StageStats> stages;
+    std::vector<std::pair<std::string, QueueStats>> queues;
+    bool ok = false;
+};
+
+namespace detail {
+
+using pipe_clock = std::chrono::steady_clock;
+
+inline double since(pipe_clock::time_point start) {
+    return std::chrono::duration<double>(pipe_clock::now() - start).count();
+}
+
+// Pushes blocks of whole lines (header skipped); the last line of a block is completed from the next read
+inline bool read_blocks(const std::string& path, BoundedQueue<std::string>& out, std::size_t blockBytes,
+                        StageStats& st) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        std::cerr << "Error opening " << path << std::endl;
+        out.close();
+        return false;
+    }
+    std::string carry;
+    bool header = true;
+    for (;;) {
+        auto start = pipe_clock::now();
+        std::string block = std::move(carry);
+        std::size_t old = block.size();
+        block.resize(old + blockBytes);
+        std::size_t got = std::fread(block.data() + old, 1, blockBytes, f);
+        block.resize(old + got);
+        bool eof = got < blockBytes;
+        if (header) {
+            std::size_t nl = block.find('\n');
+            block.erase(0, nl == std::string::npos ? block.size() : nl + 1);
+            header = nl == std::string::npos && !eof;
+        }
+        carry.clear();
+        if (!eof) {
+            std::size_t nl = block.rfind('\n');
+            std::size_t keep = nl == std::string::npos ? 0 : nl + 1;
+            carry.assign(block, keep, std::string::npos);
+            block.resize(keep);
+        }
+        st.busy_s += since(start);
+        if (!block.empty() && !out.push(std::move(block))) break;
+        if (eof) break;
+    }
+    std::fclose(f);
+    out.close();
+    return true;
+}
+
+// Stops at a row read_columns would reject; closing in then stops the reader too
+inline bool parse_blocks(BoundedQueue<std::string>& in, CardColumns& c, StageStats& st, const std::string& path) {
+    std::string block;
+    std::size_t n = 0;
+    while (in.pop(block)) {
+        auto start = pipe_clock::now();
+        std::string_view text(block);
+        while (!text.empty()) {
+            std::size_t nl = text.find('\n');
+            std::string_view line = text.substr(0, nl);
+            text.remove_prefix(nl == std::string_view::npos ? text.size() : nl + 1);
+            if (n == c.size()) c.resize(n ? 2 * n : 1024);
+            if (!parse_row(c, n++, line)) {
+                std::cerr << path << ": row " << n << " has a PIN longer than " << CardColumns::kPinDigits
+                          << " digits" << std::endl;
+                in.close();
+                c.resize(0);
+                return false;
+            }
+        }
+        st.busy_s += since(start);
+    }
+    c.resize(n);
+    st.rows = n;
+    return true;
+}
+
+} // namespace detail
+
+// Merges dump1 + dump2 into out_path, like radix_sort_dump2 + merge_linear_index + write_csv
+inline PipelineReport run_pipeline(const std::string& dump1_path, const std::string& dump2_path,
+                                   const std::string& out_path, const PipelineOptions& opt = {}) {
+    using namespace detail;
+    PipelineReport rep;
+    auto wallStart = pipe_clock::now();
+
+    StageStats read1{"read_dump1"}, read2{"read_dump2"}, parse1{"parse_dump1"}, parse2{"parse_dump2"},
+        sortSt{"sort_dump2"}, mergeSt{"merge"}, formatSt{"format"}, writeSt{"write"};
+    BoundedQueue<std::string> text1(opt.queue_capacity), text2(opt.queue_capacity);
+    BoundedQueue<CardColumns> merged(opt.queue_capacity);
+    BoundedQueue<std::string> output(opt.queue_capacity);
+
+    // ----------------- Ingest: both dumps at once -----------------
+    CardColumns d1, d2;
+    std::vector<std::uint32_t> order;
+    bool ok1 = false, ok2 = false, parsed1 = false, parsed2 = false;
+    std::thread reader1([&] { ok1 = read_blocks(dump1_path, text1, opt.block_bytes, read1); });
+    std::thread reader2([&] { ok2 = read_blocks(dump2_path, text2, opt.block_bytes, read2); });
+    std::thread parser1([&] { parsed1 = parse_blocks(text1, d1, parse1, dump1_path); });
+    std::thread parser2([&] {
+        parsed2 = parse_blocks(text2, d2, parse2, dump2_path);
+        auto start = pipe_clock::now();
+        order = sort_permutation(d2);
+        sortSt.busy_s = since(start);
+        sortSt.rows = d2.size();
+    });
+    reader1.join();
+    reader2.join();
+    parser1.join();
+    parser2.join();
+    read1.rows = parse1.rows;
+    read2.rows = parse2.rows;
+
+    rep.ok = ok1 && ok2 && parsed1 && parsed2 && d1.size() == d2.size() && d1.size() > 0;
+    if (!rep.ok) {
+        if (ok1 && ok2 && parsed1 && parsed2) std::cerr << "Row count mismatch\n";
+        return rep;
+    }
+    std::FILE* out = std::fopen(out_path.c_str(), "wb");
+    if (!out) {
+        std::cerr << "Error writing " << out_path << std::endl;
+        rep.ok = false;
+        return rep;
+    }
+
+    // ----------------- Merge, format and write, overlapped -----------------
+    std::thread formatter([&] {
+        CardColumns chunk;
+        while (merged.pop(chunk)) {
+            auto start = pipe_clock::now();
+            std::string text;
+            text.reserve(chunk.size() * 48);
+            for (std::size_t i = 0; i < chunk.size(); ++i) {
+                append_row(text, chunk, i);
+                text += '\n';
+            }
+            formatSt.rows += chunk.size();
+            formatSt.busy_s += since(start);
+            if (!output.push(std::move(text))) break;
+        }
+        output.close();
+    });
+    // a failed write closes both queues, so the merge and format stages stop early
+    bool written = true;
+    std::thread writer([&] {
+        const char* header = "Credit Card Number,Expiry Date,Verification Code,PIN,Issueing Network\n";
+        written = std::fputs(header, out) >= 0;
+        std::string text;
+        while (written && output.pop(text)) {
+            auto start = pipe_clock::now();
+            written = std::fwrite(text.data(), 1, text.size(), out) == text.size();
+            writeSt.busy_s += since(start);
+        }
+        if (!written) {
+            output.close();
+            merged.close();
+        }
+    });
+
+    for (std::size_t begin = 0; begin < d1.size(); begin += opt.chunk_rows) {
+        auto start = pipe_clock::now();
+        std::size_t end = std::min(d1.size(), begin + opt.chunk_rows);
+        CardColumns chunk = merge_rows(d1, d2, order.data(), begin, end);
+        mergeSt.rows += end - begin;
+        mergeSt.busy_s += since(start);
+        if (!merged.push(std::move(chunk))) break;
+    }
+    merged.close();
+    formatter.join();
+    writer.join();
+    writeSt.rows = formatSt.rows;
+    if (std::fclose(out) != 0) written = false;
+    if (!written) {
+        std::cerr << "Error writing " << out_path << std::endl;
+        rep.ok = false;
+    }
+
+    rep.rows = d1.size();
+    rep.wall_s = since(wallStart);
+    rep.stages = {read1, read2, parse1, parse2, sortSt, mergeSt, formatSt, writeSt};
+    rep.queues = {{"dump1_text", text1.stats()}, {"dump2_text", text2.stats()},
+                  {"merged_chunks", merged.stats()}, {"output_text", output.stats()}};
+    return rep;
+}
+
+} // namespace cards
@@ -0,0 +1,230 @@
+// Synthetic card dump generator for load testing olsen_gang
+//
+//   gen_carddump <rows> <out_dir> [--seed S] [--threads T]
+//                [--dist uniform|skewed|duplicates|sorted] [--distinct K] [--zipf S]
+//                [--years FIRST-LAST]
+//
+// Writes <out_dir>/carddump1.csv (card prefixes, masked suffix) and
+// <out_dir>/carddump2.csv (masked prefix, suffix, expiry, verification code,
+// PIN, network) in the schema of the provided dumps. Row i depends only on the
+// seed and i, so the output is identical for any thread count.
+//
+// Key distributions for (year, month, PIN) in dump2:
+//   uniform     every key equally likely, random order
+//   skewed      Zipf-distributed keys (exponent --zipf), hot keys scattered
+//   duplicates  only --distinct different keys
+//   sorted      dump2 already in (year, month, PIN) order
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <deque>
+#include <future>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+
+using namespace std;
+
+// ----------------- Options -----------------
+struct GenOptions {
+    uint64_t rows = 0;
+    string out_dir;
+    uint64_t seed = 1;
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    string dist = "uniform";
+    uint64_t distinct = 100;
+    double zipf = 1.1;
+    int first_year = 2024, last_year = 2029;
+};
+
+const char* NETWORKS[] = {
+    "Visa", "Visa", "Visa", "MasterCard", "MasterCard", "Visa Electron", "American Express",
+    "Diners Club", "Diners Club International", "JCB", "Maestro", "Maestro UK", "RuPay"};
+const int NETWORK_COUNT = sizeof(NETWORKS) / sizeof(NETWORKS[0]);
+
+// ----------------- Counter-based random numbers -----------------
+uint64_t splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Independent stream per (row, field)
+uint64_t rnd(uint64_t seed, uint64_t row, uint64_t field) {
+    return splitmix64(splitmix64(seed ^ (field * 0xD1B54A32D192ED03ull)) + row);
+}
+
+double unit(uint64_t r) { return (r >> 11) * (1.0 / 9007199254740992.0); }
+
+// ----------------- Key distributions -----------------
+// A key is an index into all (year, month, PIN) combinations
+class KeyModel {
+public:
+    enum Mode { Uniform, Skewed, Duplicates, Sorted };
+
+    explicit KeyModel(const GenOptions& o) : o_(o) {
+        keys_ = uint64_t(o.last_year - o.first_year + 1) * 12 * 10000;
+        mode_ = o.dist == "skewed" ? Skewed : o.dist == "duplicates" ? Duplicates
+              : o.dist == "sorted" ? Sorted : Uniform;
+        if (mode_ == Skewed) {
+            // CDF of Zipf over key ranks
+            cdf_.resize(keys_);
+            double sum = 0;
+            for (uint64_t k = 0; k < keys_; ++k) cdf_[k] = (sum += 1.0 / pow(double(k + 1), o.zipf));
+            for (auto& c : cdf_) c /= sum;
+        }
+    }
+
+    uint64_t key(uint64_t row) const {
+        uint64_t r = rnd(o_.seed, row, 1);
+        if (mode_ == Sorted)
+            return row * keys_ / o_.rows;  // fits in 64 bits for any realistic row count
+        if (mode_ == Duplicates) {
+            uint64_t d = max<uint64_t>(1, min(o_.distinct, keys_));
+            return (r % d) * (keys_ / d);
+        }
+        if (mode_ == Skewed) {
+            uint64_t rank = lower_bound(cdf_.begin(), cdf_.end(), unit(r)) - cdf_.begin();
+            rank = min(rank, keys_ - 1);
+            // scatter hot ranks over the key space (odd stride, coprime to keys_ = 120000 * years)
+            return (rank * 7919) % keys_;
+        }
+        return r % keys_;
+    }
+
+    int year(uint64_t k) const { return o_.first_year + int(k / 120000); }
+    int month(uint64_t k) const { return int(k / 10000 % 12) + 1; }
+    int pin(uint64_t k) const { return int(k % 10000); }
+
+private:
+    const GenOptions& o_;
+    Mode mode_;
+    uint64_t keys_;
+    vector<double> cdf_;
+};
+
+// ----------------- Formatting -----------------
+char* put_digits(char* p, uint64_t v, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        p[i] = char('0' + v % 10);
+        v /= 10;
+    }
+    return p + width;
+}
+
+struct Chunk {
+    string dump1, dump2;
+};
+
+Chunk make_chunk(const GenOptions& o, const KeyModel& model, uint64_t begin, uint64_t end) {
+    Chunk c;
+    c.dump1.resize((end - begin) * 24);
+    c.dump2.resize((end - begin) * 72);
+    char* p1 = c.dump1.data();
+    char* p2 = c.dump2.data();
+
+    for (uint64_t i = begin; i < end; ++i) {
+        // dump1: "dddd-dddd-dddd-****,,,,"
+        uint64_t prefix = rnd(o.seed, i, 0) % 100000000000ull + uint64_t(3 + i % 4) * 100000000000ull;
+        char digits[12];
+        put_digits(digits, prefix, 12);
+        for (int g = 0; g < 3; ++g) {
+            memcpy(p1, digits + 4 * g, 4);
+            p1[4] = '-';
+            p1 += 5;
+        }
+        memcpy(p1, "****,,,,\n", 9);
+        p1 += 9;
+
+        // dump2: "****-****-****-dddd,MM/YYYY,vvv,pppp,Network"
+        uint64_t k = model.key(i);
+        uint64_t r = rnd(o.seed, i, 2);
+        memcpy(p2, "****-****-****-", 15);
+        p2 = put_digits(p2 + 15, r % 10000, 4);
+        *p2++ = ',';
+        p2 = put_digits(p2, model.month(k), 2);
+        *p2++ = '/';
+        p2 = put_digits(p2, model.year(k), 4);
+        *p2++ = ',';
+        p2 = put_digits(p2, r / 10000 % 1000, 3);
+        *p2++ = ',';
+        p2 = put_digits(p2, model.pin(k), 4);
+        *p2++ = ',';
+        const char* net = NETWORKS[r / 10000000 % NETWORK_COUNT];
+        size_t len = strlen(net);
+        memcpy(p2, net, len);
+        p2 += len;
+        *p2++ = '\n';
+    }
+    c.dump1.resize(p1 - c.dump1.data());
+    c.dump2.resize(p2 - c.dump2.data());
+    return c;
+}
+
+// ----------------- Main -----------------
+int usage() {
+    cerr << "usage: gen_carddump <rows> <out_dir> [--seed S] [--threads T]\n"
+            "                    [--dist uniform|skewed|duplicates|sorted] [--distinct K] [--zipf S]\n"
+            "                    [--years FIRST-LAST]\n";
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    GenOptions o;
+    vector<string> pos;
+    for (int i = 1; i < argc; ++i) {
+        string a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (a == "--seed" && hasValue) o.seed = stoull(argv[++i]);
+        else if (a == "--threads" && hasValue) o.threads = max(1, stoi(argv[++i]));
+        else if (a == "--dist" && hasValue) o.dist = argv[++i];
+        else if (a == "--distinct" && hasValue) o.distinct = stoull(argv[++i]);
+        else if (a == "--zipf" && hasValue) o.zipf = stod(argv[++i]);
+        else if (a == "--years" && hasValue && sscanf(argv[++i], "%d-%d", &o.first_year, &o.last_year) == 2) {}
+        else pos.push_back(a);
+    }
+    if (pos.size() != 2 || o.last_year < o.first_year) return usage();
+    if (o.dist != "uniform" && o.dist != "skewed" && o.dist != "duplicates" && o.dist != "sorted") return usage();
+    o.rows = stoull(pos[0]);
+    o.out_dir = pos[1];
+
+    const string header = "Credit Card Number,Expiry Date,Verification Code,PIN,Issueing Network\n";
+    FILE* f1 = fopen((o.out_dir + "/carddump1.csv").c_str(), "wb");
+    FILE* f2 = fopen((o.out_dir + "/carddump2.csv").c_str(), "wb");
+    if (!f1 || !f2) { cerr << "Error writing to " << o.out_dir << endl; return 1; }
+    auto put = [](const string& s, FILE* f) { return fwrite(s.data(), 1, s.size(), f) == s.size(); };
+    bool ok = put(header, f1) && put(header, f2);
+
+    auto start = chrono::steady_clock::now();
+    KeyModel model(o);
+
+    // chunks are generated in parallel and written in order, at most 2 per thread in flight
+    const uint64_t chunkRows = 1 << 16;
+    deque<future<Chunk>> inFlight;
+    uint64_t next = 0;
+    auto submit = [&] {
+        uint64_t end = min(o.rows, next + chunkRows);
+        inFlight.push_back(async(launch::async, make_chunk, cref(o), cref(model), next, end));
+        next = end;
+    };
+    while (next < o.rows && inFlight.size() < 2 * o.threads) submit();
+    while (ok && !inFlight.empty()) {
+        Chunk c = inFlight.front().get();
+        inFlight.pop_front();
+        if (next < o.rows) submit();
+        ok = put(c.dump1, f1) && put(c.dump2, f2);
+    }
+    bool closed1 = fclose(f1) == 0, closed2 = fclose(f2) == 0;
+    if (!ok || !closed1 || !closed2) { cerr << "Error writing to " << o.out_dir << endl; return 1; }
+
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Generated " << o.rows << " rows (" << o.dist << ", seed " << o.seed << ") into "
+         << o.out_dir << " in " << secs << " s (" << o.rows / max(secs, 1e-9) / 1e6 << " M rows/s)\n";
+    return 0;
+}
@@ -5,9 +5,17 @@
 #include <string>
 #include <algorithm>
 #include <chrono>
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+#include "sort_lib.h"
+#include "card_columns.h"
+#include "card_bin.h"
+#include "card_delta.h"
+#include "card_pipeline.h"
+#include "../common/bench.h"
 
 using namespace std;
-using namespace chrono;
 
 // ----------------- Struct -----------------
 struct CardRow {
@@ -50,6 +58,7 @@ int safe_stoi(const string& s){
 }
 
 // ----------------- CSV -----------------
+// Empty if the file is missing or a PIN does not fit the 4 digits of card_key and radix_sort_dump2
 vector<CardRow> read_csv(const string& path) {
     vector<CardRow> rows;
     ifstream file(path);
@@ -65,6 +74,12 @@ vector<CardRow> read_csv(const string& path) {
         getline(ss, r.verification, ',');
         getline(ss, r.pin, ',');
         getline(ss, r.network, ',');
+        if (count_if(r.pin.begin(), r.pin.end(), [](unsigned char ch) { return isdigit(ch); }) >
+            cards::CardColumns::kPinDigits) {
+            cerr << path << ": row " << rows.size() + 1 << " has a PIN longer than "
+                 << cards::CardColumns::kPinDigits << " digits" << endl;
+            return {};
+        }
         rows.push_back(r);
     }
     return rows;
@@ -116,17 +131,27 @@ vector<CardRow> merge_linear_index(const vector<CardRow>& dump1, const vector<Ca
 }
 
 // ----------------- Log-linear merge -----------------
-vector<CardRow> merge_loglinear(vector<CardRow> d1, vector<CardRow> d2) {
-    auto cmp = [](const CardRow& a, const CardRow& b) {
-        int y1,m1,y2,m2;
-        parse_expiry(a.expiry,m1,y1); parse_expiry(b.expiry,m2,y2);
-        if(y1!=y2) return y1<y2;
-        if(m1!=m2) return m1<m2;
-        return safe_stoi(a.pin) < safe_stoi(b.pin);
+// (year, month, PIN) packed into one integer, read straight from "MM/YYYY" and the PIN digits
+long long card_key(const CardRow& r) {
+    auto digits = [](const string& s, size_t from, size_t to) {
+        long long v = 0;
+        for (size_t i = from; i < to && i < s.size(); ++i)
+            if (isdigit(static_cast<unsigned char>(s[i]))) v = v * 10 + (s[i] - '0');
+        return v;
     };
+    size_t slash = r.expiry.find('/');
+    long long month = slash == string::npos ? 0 : digits(r.expiry, 0, slash);
+    long long year  = slash == string::npos ? 0 : digits(r.expiry, slash + 1, r.expiry.size());
+    return (year * 13 + month) * 10000 + digits(r.pin, 0, r.pin.size());
+}
+
+struct ByExpiryPin {
+    bool operator()(const CardRow& a, const CardRow& b) const { return card_key(a) < card_key(b); }
+};
 
-    stable_sort(d1.begin(), d1.end(), cmp);
-    stable_sort(d2.begin(), d2.end(), cmp);
+vector<CardRow> merge_loglinear(vector<CardRow> d1, vector<CardRow> d2) {
+    sortlib::merge_sort(d1.begin(), d1.end(), ByExpiryPin{});
+    sortlib::merge_sort(d2.begin(), d2.end(), ByExpiryPin{});
 
     vector<CardRow> merged;
     merged.reserve(d1.size());
@@ -139,61 +164,378 @@ vector<CardRow> merge_loglinear(vector<CardRow> d1, vector<CardRow> d2) {
     return merged;
 }
 
-// ----------------- Timing -----------------
-template<typename Func>
-double timeit(Func f){
-    auto start = high_resolution_clock::now();
-    f();
-    auto end = high_resolution_clock::now();
-    return duration_cast<duration<double>>(end-start).count();
+// ----------------- Memory per row -----------------
+// The row structs plus every string that outgrew the small-string buffer
+double aos_row_bytes(const vector<CardRow>& rows) {
+    size_t bytes = rows.size() * sizeof(CardRow);
+    for (const auto& r : rows)
+        for (const string* s : {&r.card_number, &r.expiry, &r.verification, &r.pin, &r.network})
+            if (s->capacity() > string().capacity()) bytes += s->capacity() + 1;
+    return rows.empty() ? 0 : double(bytes) / rows.size();
+}
+
+// Row footprint streamed per second: a bandwidth estimate for one sort + merge
+void record_bandwidth(bench::Result& r, double rowBytes) {
+    r.metric("bytes_per_row", rowBytes);
+    r.metric("gb_per_s", rowBytes * r.n / r.stats.median / 1e9);
+}
+
+// ----------------- Binary snapshots -----------------
+// dump2 in (year, month, PIN) order without sorting when the snapshot is stored
+// sorted or has a sidecar index; sorts otherwise
+cards::CardColumns load_sorted(const cards::MappedDump& d) {
+    if (d.sorted()) return d.to_columns();
+    if (d.index()) return d.to_columns(d.index());
+    cards::CardColumns c = d.to_columns();
+    cards::radix_sort_dump2(c);
+    return c;
+}
+
+// Merges carddump1.bin + carddump2.bin, (re)written from the CSVs when missing
+// or made from an older version of the CSV. dump1 is joined in its CSV row
+// order, so a dump1 snapshot stored sorted (csv2bin --sort) is rewritten too.
+int run_binary(bench::Suite& suite, const string& data_path, const string& res_path) {
+    const string bin1 = data_path + "carddump1.bin", bin2 = data_path + "carddump2.bin";
+    for (const string& bin : {bin1, bin2}) {
+        string csv = bin.substr(0, bin.size() - 4) + ".csv";
+        auto stamp = cards::source_stamp(csv);
+        if (ifstream(bin).good()) {
+            cards::MappedDump existing;
+            bool opened = existing.open(bin);
+            bool reordered = opened && bin == bin1 && existing.reordered();
+            if (opened && !reordered && (existing.from_source(stamp) || stamp.size == 0)) continue;  // no CSV: use the snapshot
+            if (reordered && stamp.size == 0) {
+                cerr << bin << " is stored sorted, but dump1 must keep its CSV row order, and " << csv << " is missing\n";
+                return 1;
+            }
+            cout << bin << (!opened ? " is unreadable" : reordered ? " is stored sorted, not in CSV row order"
+                                                                   : " was made from another version of " + csv)
+                 << ", rebuilding\n";
+        }
+        auto cols = cards::read_columns(csv);
+        if (cols.size() == 0 || !cards::write_bin(bin, cols, false, stamp) || (bin == bin2 && !cards::write_index(bin)))
+            return 1;
+        cout << "Converted " << csv << " -> " << bin << "\n";
+    }
+
+    cards::MappedDump d1, d2;
+    if (!d1.open(bin1) || !d2.open(bin2) || !d1.verify() || !d2.verify()) return 1;
+    if (d1.size() != d2.size()) { cerr << "Row count mismatch\n"; return 1; }
+    d2.open_index();
+    const size_t N = d2.size();
+    cout << "\nBinary snapshots: " << N << " rows, dump2 "
+         << (d2.sorted() ? "stored sorted" : d2.index() ? "indexed" : "unsorted") << "\n";
+
+    // ----------------- Load and merge timing -----------------
+    double t_csv = suite.run({"load", N, "csv"}, [&](){
+        auto c1 = cards::read_columns(data_path + "carddump1.csv");
+        auto c2 = cards::read_columns(data_path + "carddump2.csv");
+        bench::do_not_optimize(c1);
+        bench::do_not_optimize(c2);
+    }).stats.median;
+
+    double t_open = suite.run({"load", N, "bin"}, [&](){
+        cards::MappedDump m1, m2;
+        bool ok = m1.open(bin1) && m2.open(bin2);
+        bench::do_not_optimize(ok);
+    }).stats.median;
+
+    double t_verified = suite.run({"load", N, "bin_verified"}, [&](){
+        cards::MappedDump m1, m2;
+        bool ok = m1.open(bin1) && m2.open(bin2) && m1.verify() && m2.verify();
+        bench::do_not_optimize(ok);
+    }).stats.median;
+
+    double t_merge = suite.run({"linear_merge", N, "bin"}, [&](){
+        auto m = cards::merge_linear_index(d1.to_columns(), load_sorted(d2));
+        bench::do_not_optimize(m);
+    }).stats.median;
+
+    double t_resort = suite.run({"linear_merge", N, "bin_resort"}, [&](){
+        auto c2 = d2.to_columns();
+        cards::radix_sort_dump2(c2);
+        auto m = cards::merge_linear_index(d1.to_columns(), c2);
+        bench::do_not_optimize(m);
+    }).stats.median;
+
+    cout << "Parse CSV\t" << t_csv << " s\n"
+         << "Map bin\t\t" << t_open << " s\n"
+         << "Map+verify\t" << t_verified << " s\n"
+         << "Merge (stored order)\t" << t_merge << " s\n"
+         << "Merge (re-sort)\t\t" << t_resort << " s\n";
+    suite.write();
+
+    auto merged = cards::merge_linear_index(d1.to_columns(), load_sorted(d2));
+    cards::write_csv(res_path + "carddump_sorted_full.csv", merged);
+    cout << "\nFinal merged CSV created: " << res_path + "carddump_sorted_full.csv\n";
+    cout << "DONE.\n";
+    return 0;
+}
+
+// ----------------- Incremental merge -----------------
+// Full rebuild for comparison: drop every touched row, append the delta, re-sort everything
+cards::CardColumns full_resort(const cards::CardColumns& base, const cards::Delta& delta) {
+    unordered_set<uint64_t> touched;
+    for (size_t j = 0; j < delta.rows.size(); ++j) touched.insert(cards::card_id(delta.rows, j));
+    cards::CardColumns all;
+    all.networks = base.networks;
+    all.resize(base.size() + delta.rows.size());
+    size_t n = 0;
+    for (size_t i = 0; i < base.size(); ++i)
+        if (!touched.count(cards::card_id(base, i))) cards::detail::copy_row(all, n++, base, i);
+    unordered_map<uint64_t, size_t> last;  // last operation per card wins
+    for (size_t j = 0; j < delta.rows.size(); ++j) last[cards::card_id(delta.rows, j)] = j;
+    for (size_t j = 0; j < delta.rows.size(); ++j) {
+        if (last[cards::card_id(delta.rows, j)] != j || delta.ops[j] == 'D') continue;
+        cards::detail::copy_row(all, n, delta.rows, j);
+        all.network[n++] = all.network_id(delta.rows.networks[delta.rows.network[j]]);
+    }
+    all.resize(n);
+    cards::radix_sort_dump2(all);
+    return all;
+}
+
+// Applies a delta (op CSV, or a directory with a dump pair of new rows) to the merged result.
+// check also benchmarks it against a full re-sort and requires both to agree.
+int run_delta(bench::Suite& suite, const string& res_path, const string& delta_path, bool check) {
+    const string merged_path = res_path + "carddump_sorted_full.csv";
+    auto base = cards::read_columns(merged_path);
+    if (base.size() == 0) { cerr << "No merged result to update; run the full merge first\n"; return 1; }
+
+    cards::Delta delta;
+    if (filesystem::is_directory(delta_path)) {
+        auto d1 = cards::read_columns(delta_path + "/carddump1.csv");
+        auto d2 = cards::read_columns(delta_path + "/carddump2.csv");
+        if (d1.size() != d2.size()) { cerr << "Row count mismatch\n"; return 1; }
+        delta = cards::delta_from_dumps(d1, d2);
+    } else
+        delta = cards::read_delta(delta_path);
+    if (delta.ops.empty()) { cerr << "Empty delta: " << delta_path << "\n"; return 1; }
+
+    const size_t N = base.size();
+    cards::DeltaStats st;
+    auto start = chrono::steady_clock::now();
+    auto updated = cards::apply_delta(base, delta, &st);
+    double t_apply = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "\nDelta of " << delta.ops.size() << " rows on " << N << " merged rows: "
+         << st.added << " added, " << st.updated << " updated, " << st.deleted << " deleted";
+    if (st.missing) cout << ", " << st.missing << " not found";
+    cout << "\nDelta merge\t" << t_apply << " s\n";
+
+    if (check) {
+        const string k = "delta=" + to_string(delta.ops.size());
+        double t_delta = suite.run({"delta_merge", N, k}, [&](){
+            auto m = cards::apply_delta(base, delta);
+            bench::do_not_optimize(m);
+        }).stats.median;
+        double t_full = suite.run({"full_resort", N, k}, [&](){
+            auto m = full_resort(base, delta);
+            bench::do_not_optimize(m);
+        }).stats.median;
+        suite.write();
+
+        auto rebuilt = full_resort(base, delta);
+        bool same = updated.size() == rebuilt.size();
+        for (size_t i = 0; same && i < updated.size(); ++i)
+            same = cards::format_row(updated, i) == cards::format_row(rebuilt, i);
+        cout << "Delta merge (median)\t" << t_delta << " s\nFull re-sort (median)\t" << t_full << " s\n"
+             << "Delta merge " << (same ? "matches" : "DIFFERS from") << " the full re-sort\n";
+        if (!same) return 1;
+    }
+
+    cards::write_csv(merged_path, updated);
+    cout << "\nUpdated merged CSV: " << merged_path << " (" << updated.size() << " rows)\n";
+    cout << "DONE.\n";
+    return 0;
+}
+
+// ----------------- Pipelined merge -----------------
+void print_pipeline(const cards::PipelineReport& rep) {
+    cout << "\nPipeline: " << rep.rows << " rows in " << rep.wall_s << " s\n";
+    cout << "Stage\t\tbusy(s)\tM rows/s\tbusy/wall\n";
+    const cards::StageStats* slowest = nullptr;
+    for (const auto& st : rep.stages) {
+        cout << st.name << "\t" << st.busy_s << "\t" << (st.busy_s > 0 ? st.rows / st.busy_s / 1e6 : 0)
+             << "\t" << st.busy_s / rep.wall_s << "\n";
+        if (!slowest || st.busy_s > slowest->busy_s) slowest = &st;
+    }
+    cout << "Queue\t\titems\tmean/cap\tmax\tpush wait(s)\tpop wait(s)\n";
+    for (const auto& [name, q] : rep.queues)
+        cout << name << "\t" << q.items << "\t" << q.mean_occupancy << "/" << q.capacity << "\t"
+             << q.max_occupancy << "\t" << q.push_wait_s << "\t" << q.pop_wait_s << "\n";
+    if (slowest) cout << "Busiest stage: " << slowest->name << "\n";
+}
+
+// Staged concurrent merge (card_pipeline.h) against the same steps run one after another
+int run_pipelined(bench::Suite& suite, const string& data_path, const string& res_path) {
+    const string in1 = data_path + "carddump1.csv", in2 = data_path + "carddump2.csv";
+    const string out = res_path + "carddump_sorted_full.csv";
+    const string seqOut = res_path + "carddump_sorted_sequential.csv";
+
+    auto rep = cards::run_pipeline(in1, in2, out);
+    if (!rep.ok) return 1;
+    const size_t N = rep.rows;
+
+    auto& seq = suite.run({"ingest_sort_merge_write", N, "sequential"}, [&](){
+        auto d1 = cards::read_columns(in1);
+        auto d2 = cards::read_columns(in2);
+        auto order = cards::sort_permutation(d2);
+        cards::write_csv(seqOut, cards::merge_linear_index(d1, d2, &order));
+    });
+    bool ok = true;
+    auto& piped = suite.run({"ingest_sort_merge_write", N, "pipeline"}, [&](){
+        rep = cards::run_pipeline(in1, in2, out);
+        ok = ok && rep.ok;
+    });
+    if (!ok) return 1;
+    for (const auto& st : rep.stages) piped.metric(st.name + "_busy_s", st.busy_s);
+    for (const auto& [name, q] : rep.queues) piped.metric(name + "_occupancy", q.mean_occupancy / q.capacity);
+    suite.write();
+
+    print_pipeline(rep);
+    cout << "\nSequential\t" << seq.stats.median << " s\nPipeline\t" << piped.stats.median << " s\n";
+
+    ifstream a(out, ios::binary), b(seqOut, ios::binary);
+    bool same = equal(istreambuf_iterator<char>(a), istreambuf_iterator<char>(),
+                      istreambuf_iterator<char>(b), istreambuf_iterator<char>());
+    remove(seqOut.c_str());
+    cout << "Pipeline output " << (same ? "matches" : "DIFFERS from") << " the sequential merge\n";
+    if (!same) return 1;
+    cout << "\nFinal merged CSV created: " << out << "\nDONE.\n";
+    return 0;
 }
 
 // ----------------- Main -----------------
-int main() {
-    const string data_path = "assignment_1/data/";
-    const string res_path  = "assignment_1/results/";
+//   olsen_gang [--data DIR] [--results DIR] [--bin] [harness flags]
+// --data reads another dump pair, e.g. one written by gen_carddump; its results
+// then go next to it unless --results says otherwise. --bin merges the binary
+// snapshots of the dumps (see card_convert) instead of the CSVs.
+//   olsen_gang --delta PATH [--results DIR] [--check]
+// applies a delta to the merged result in place (see card_delta.h); --check
+// also times it against a full re-sort and verifies both give the same rows.
+//   olsen_gang --pipeline [--data DIR] [--results DIR]
+// runs the merge as concurrent stages and reports each stage (card_pipeline.h).
+int main(int argc, char** argv) {
+    bench::Suite suite("olsen_gang", bench::parse_args(argc, argv));
+    string data_path = "assignment_1/data/";
+    string res_path  = "assignment_1/results/";
+    bool customResults = false, binary = false, pipelined = false, check = false;
+    string delta_path;
+    for (int i = 1; i < argc; ++i) {
+        string a = argv[i];
+        if (a == "--data" && i + 1 < argc) {
+            data_path = string(argv[++i]) + "/";
+            if (!customResults) res_path = data_path;
+        }
+        else if (a == "--results" && i + 1 < argc) { res_path = string(argv[++i]) + "/"; customResults = true; }
+        else if (a == "--bin") binary = true;
+        else if (a == "--pipeline") pipelined = true;
+        else if (a == "--delta" && i + 1 < argc) delta_path = argv[++i];
+        else if (a == "--check") check = true;
+        else { cerr << "usage: olsen_gang [--data DIR] [--results DIR] [--bin | --delta PATH [--check] | --pipeline]\n"; return 2; }
+    }
+    if (!delta_path.empty()) return run_delta(suite, res_path, delta_path, check);
+    if (pipelined) return run_pipelined(suite, data_path, res_path);
+    if (binary) return run_binary(suite, data_path, res_path);
 
     auto dump2_orig = read_csv(data_path + "carddump2.csv");
     if(dump2_orig.empty()) return 1;
     auto dump1_orig = read_csv(data_path + "carddump1.csv");
+    if(dump1_orig.empty()) return 1;
     if(dump1_orig.size() != dump2_orig.size()){ cerr << "Row count mismatch\n"; return 1; }
+    auto cols1_orig = cards::read_columns(data_path + "carddump1.csv");
+    auto cols2_orig = cards::read_columns(data_path + "carddump2.csv");
+    const double aosBytes = aos_row_bytes(dump1_orig) / 2 + aos_row_bytes(dump2_orig) / 2;
+    const double soaBytes = cards::CardColumns::row_bytes();
 
     // ----------------- Empirical timing -----------------
-    vector<size_t> sizes = {1000,2000,5000,10000,20000};
+    // 1-2-5 steps up to the full dump
+    vector<size_t> sizes;
+    for (size_t scale = 1000; scale <= dump2_orig.size(); scale *= 10)
+        for (size_t m : {1, 2, 5})
+            if (m * scale <= dump2_orig.size()) sizes.push_back(m * scale);
+    if (sizes.empty() || sizes.back() != dump2_orig.size()) sizes.push_back(dump2_orig.size());
 
-    cout << "\nEmpirical timing study (Linear vs Log-linear):\n";
-    cout << "N\tLinear(s)\tLogLinear(s)\n";
+    cout << "\nEmpirical timing study (Linear vs Log-linear, rows vs columns):\n";
+    cout << "Row layout " << aosBytes << " B/row, column layout " << soaBytes << " B/row\n";
+    cout << "N\tLinear(s)\tLogLinear(s)\tColLinear(s)\tColLazy(s)\tColLogLinear(s)   (median)\n";
 
     for(auto N : sizes){
         vector<CardRow> d1(dump1_orig.begin(), dump1_orig.begin()+N);
         vector<CardRow> d2(dump2_orig.begin(), dump2_orig.begin()+N);
 
         // Linear merge (radix sort + merge)
-        double t_linear = timeit([&](){
-            vector<CardRow> temp_d2 = d2;
+        auto& linear = suite.run({"linear_merge", N}, [&](){ return d2; }, [&](vector<CardRow>& temp_d2){
             radix_sort_dump2(temp_d2);
             auto m = merge_linear_index(d1,temp_d2);
+            bench::do_not_optimize(m);
         });
+        record_bandwidth(linear, aosBytes);
 
         // Log-linear merge
-        double t_loglinear = timeit([&](){
+        auto& loglinear = suite.run({"loglinear_merge", N}, [&](){
             auto m = merge_loglinear(d1,d2);
+            bench::do_not_optimize(m);
+        });
+        record_bandwidth(loglinear, aosBytes);
+
+        // Same merges on the columnar layout
+        cards::CardColumns c1 = cols1_orig, c2 = cols2_orig;
+        c1.resize(N);
+        c2.resize(N);
+
+        // radix sort permutation applied column by column, then merged
+        auto& colLinear = suite.run({"linear_merge", N, "columns"}, [&](){ return c2; }, [&](cards::CardColumns& temp_c2){
+            cards::radix_sort_dump2(temp_c2);
+            auto m = cards::merge_linear_index(c1, temp_c2);
+            bench::do_not_optimize(m);
+        });
+        record_bandwidth(colLinear, soaBytes);
+
+        // the merge reads dump2 through the permutation
+        auto& colLazy = suite.run({"linear_merge", N, "columns_lazy"}, [&](){
+            auto order = cards::sort_permutation(c2);
+            auto m = cards::merge_linear_index(c1, c2, &order);
+            bench::do_not_optimize(m);
         });
+        record_bandwidth(colLazy, soaBytes);
 
-        cout << N << "\t" << t_linear << "\t" << t_loglinear << "\n";
+        auto& colLoglinear = suite.run({"loglinear_merge", N, "columns"}, [&](){
+            auto m = cards::merge_loglinear(c1, c2);
+            bench::do_not_optimize(m);
+        });
+        record_bandwidth(colLoglinear, soaBytes);
+
+        cout << N << "\t" << linear.stats.median << "\t" << loglinear.stats.median << "\t"
+             << colLinear.stats.median << "\t" << colLazy.stats.median << "\t" << colLoglinear.stats.median << "\n";
     }
+    suite.write();
 
     // ----------------- Final linear merge dump1 + dump2 ----------
     vector<CardRow> sorted_d2 = dump2_orig;
     radix_sort_dump2(sorted_d2);
     auto final_merged = merge_linear_index(dump1_orig, sorted_d2);
 
+    // the columnar merge must produce the same rows
+    auto order = cards::sort_permutation(cols2_orig);
+    auto final_columns = cards::merge_linear_index(cols1_orig, cols2_orig, &order);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < final_merged.size(); ++i) {
+        const auto& r = final_merged[i];
+        if (cards::format_row(final_columns, i) != r.card_number + "," + r.expiry + "," + r.verification + "," + r.pin + "," + r.network)
+            ++mismatches;
+    }
+    cout << "\nColumnar merge: " << (mismatches ? to_string(mismatches) + " rows differ from the row layout" : "matches the row layout") << "\n";
 
-    cout << "\n=== Final merged dump1 + dump2 ===\n";
-    cout << "Credit Card Number,Expiry Date,Verification Code,PIN,Issueing Network\n";
-    for (const auto& r : final_merged) {
-        cout << r.card_number << "," << r.expiry << "," << r.verification << ","
-             << r.pin << "," << r.network << "\n";
+    // generated dumps can be millions of rows: only echo dumps of the original size
+    if (final_merged.size() <= 20000) {
+        cout << "\n=== Final merged dump1 + dump2 ===\n";
+        cout << "Credit Card Number,Expiry Date,Verification Code,PIN,Issueing Network\n";
+        for (const auto& r : final_merged) {
+            cout << r.card_number << "," << r.expiry << "," << r.verification << ","
+                 << r.pin << "," << r.network << "\n";
+        }
     }
 
     write_csv(res_path + "carddump_sorted_full.csv", final_merged);
@@ -0,0 +1,166 @@
+// Radix sorts for 32/64-bit integer keys
+//
+// lsd_sort: least-significant-digit first, all digit histograms built in one
+// pass, ping-pong between the array and one buffer, trivial digits skipped.
+// msd_sort: most-significant-digit first, in place (American flag sort).
+//
+// Both take a key function returning an unsigned integer; to_unsigned() maps
+// signed keys so that unsigned order matches signed order.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace radix {
+
+inline std::uint32_t to_unsigned(std::int32_t k)  { return static_cast<std::uint32_t>(k) ^ 0x80000000u; }
+inline std::uint64_t to_unsigned(std::int64_t k)  { return static_cast<std::uint64_t>(k) ^ 0x8000000000000000ull; }
+inline std::uint32_t to_unsigned(std::uint32_t k) { return k; }
+inline std::uint64_t to_unsigned(std::uint64_t k) { return k; }
+
+// ----------------- LSD -----------------
+template <unsigned Bits = 8, class T, class KeyFn>
+void lsd_sort(T* a, std::size_t n, KeyFn key) {
+    using U = std::decay_t<decltype(key(a[0]))>;
+    static_assert(std::is_unsigned_v<U>, "radix key must be unsigned");
+    constexpr unsigned passes = (sizeof(U) * 8 + Bits - 1) / Bits;
+    constexpr std::size_t buckets = std::size_t(1) << Bits;
+    constexpr U mask = U(buckets - 1);
+    if (n < 2) return;
+
+    // every digit's histogram from a single read of the input
+    std::vector<std::size_t> hist(passes * buckets, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        U k = key(a[i]);
+        for (unsigned p = 0; p < passes; ++p)
+            hist[p * buckets + ((k >> (p * Bits)) & mask)]++;
+    }
+
+    std::vector<T> buf(n);
+    T* src = a;
+    T* dst = buf.data();
+    for (unsigned p = 0; p < passes; ++p) {
+        std::size_t* h = &hist[p * buckets];
+        unsigned shift = p * Bits;
+        if (h[(key(src[0]) >> shift) & mask] == n) continue;  // all keys share this digit
+
+        std::size_t sum = 0;
+        for (std::size_t b = 0; b < buckets; ++b) {
+            std::size_t c = h[b];
+            h[b] = sum;
+            sum += c;
+        }
+        for (std::size_t i = 0; i < n; ++i)
+            dst[h[(key(src[i]) >> shift) & mask]++] = std::move(src[i]);
+        std::swap(src, dst);
+    }
+    if (src != a)
+        for (std::size_t i = 0; i < n; ++i) a[i] = std::move(src[i]);
+}
+
+// ----------------- MSD (American flag) -----------------
+namespace detail {
+
+template <unsigned Bits, class T, class KeyFn>
+void msd_rec(T* a, std::size_t n, KeyFn& key, int shift) {
+    using U = std::decay_t<decltype(key(a[0]))>;
+    constexpr std::size_t buckets = std::size_t(1) << Bits;
+    constexpr U mask = U(buckets - 1);
+
+    if (n <= 64) {
+        // insertion sort on the full key for small buckets
+        for (std::size_t i = 1; i < n; ++i) {
+            T v = std::move(a[i]);
+            U k = key(v);
+            std::size_t j = i;
+            while (j > 0 && k < key(a[j - 1])) {
+                a[j] = std::move(a[j - 1]);
+                --j;
+            }
+            a[j] = std::move(v);
+        }
+        return;
+    }
+
+    std::size_t count[buckets] = {};
+    for (std::size_t i = 0; i < n; ++i)
+        count[(key(a[i]) >> shift) & mask]++;
+
+    std::size_t head[buckets], tail[buckets];
+    std::size_t sum = 0;
+    for (std::size_t b = 0; b < buckets; ++b) {
+        head[b] = sum;
+        sum += count[b];
+        tail[b] = sum;
+    }
+
+    // cycle each misplaced element into its bucket
+    for (std::size_t b = 0; b < buckets; ++b) {
+        while (head[b] < tail[b]) {
+            T v = std::move(a[head[b]]);
+            std::size_t d = (key(v) >> shift) & mask;
+            while (d != b) {
+                std::swap(v, a[head[d]++]);
+                d = (key(v) >> shift) & mask;
+            }
+            a[head[b]++] = std::move(v);
+        }
+    }
+
+    if (shift == 0) return;
+    int next = shift > int(Bits) ? shift - int(Bits) : 0;
+    std::size_t start = 0;
+    for (std::size_t b = 0; b < buckets; ++b) {
+        if (count[b] > 1) msd_rec<Bits>(a + start, count[b], key, next);
+        start += count[b];
+    }
+}
+
+} // namespace detail
+
+template <unsigned Bits = 8, class T, class KeyFn>
+void msd_sort(T* a, std::size_t n, KeyFn key) {
+    using U = std::decay_t<decltype(key(a[0]))>;
+    static_assert(std::is_unsigned_v<U>, "radix key must be unsigned");
+    if (n < 2) return;
+    int top = int(sizeof(U) * 8) - int(Bits);
+    detail::msd_rec<Bits>(a, n, key, top > 0 ? top : 0);
+}
+
+// ----------------- Convenience overloads -----------------
+template <unsigned Bits = 8>
+void lsd_sort(std::vector<int>& v) {
+    lsd_sort<Bits>(v.data(), v.size(), [](int x) { return to_unsigned(std::int32_t(x)); });
+}
+
+template <unsigned Bits = 8>
+void lsd_sort(std::vector<std::uint64_t>& v) {
+    lsd_sort<Bits>(v.data(), v.size(), [](std::uint64_t x) { return x; });
+}
+
+// Key/value pairs, ordered by key (stable)
+template <unsigned Bits = 8, class K, class V>
+void lsd_sort(std::vector<std::pair<K, V>>& v) {
+    lsd_sort<Bits>(v.data(), v.size(), [](const std::pair<K, V>& p) { return to_unsigned(p.first); });
+}
+
+template <unsigned Bits = 8>
+void msd_sort(std::vector<int>& v) {
+    msd_sort<Bits>(v.data(), v.size(), [](int x) { return to_unsigned(std::int32_t(x)); });
+}
+
+template <unsigned Bits = 8>
+void msd_sort(std::vector<std::uint64_t>& v) {
+    msd_sort<Bits>(v.data(), v.size(), [](std::uint64_t x) { return x; });
+}
+
+// Key/value pairs, ordered by key (not stable)
+template <unsigned Bits = 8, class K, class V>
+void msd_sort(std::vector<std::pair<K, V>>& v) {
+    msd_sort<Bits>(v.data(), v.size(), [](const std::pair<K, V>& p) { return to_unsigned(p.first); });
+}
+
+} // namespace radix
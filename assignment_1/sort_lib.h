@@ -0,0 +1,237 @@
+// Header-only sorting library: bubble, insertion, merge and quick sorts
+//
+// Every sort is templated on a random-access iterator and a comparator
+// (std::less<> by default) so the comparison inlines, and indexes with size_t.
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "sorting_network.h"
+
+namespace sortlib {
+
+struct Options {
+    std::size_t leaf = 0;           // subranges of at most this many elements go to the leaf sort (0 = off)
+    long long* pivots = nullptr;    // if set, incremented once per pivot chosen
+};
+
+namespace detail {
+
+template <class It>
+using value_t = typename std::iterator_traits<It>::value_type;
+
+// Sorting networks only apply to plain ascending ints, and only pay off vectorized
+template <class It, class Compare>
+constexpr bool network_leaf =
+    sortnet::kVectorized && std::is_same_v<value_t<It>, int> &&
+    (std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<int>>);
+
+template <class It, class Compare>
+void insertion(It a, std::size_t lo, std::size_t hi, Compare& comp) {
+    for (std::size_t i = lo + 1; i < hi; ++i) {
+        value_t<It> key = std::move(a[i]);
+        std::size_t j = i;
+        while (j > lo && comp(key, a[j - 1])) {
+            a[j] = std::move(a[j - 1]);
+            --j;
+        }
+        a[j] = std::move(key);
+    }
+}
+
+// Sorts [lo, hi) if it is at most opt.leaf elements long
+template <class It, class Compare>
+bool leaf(It a, std::size_t lo, std::size_t hi, Compare& comp, const Options& opt) {
+    std::size_t n = hi - lo;
+    if (n > opt.leaf) return false;
+    if constexpr (network_leaf<It, Compare>) {
+        if (n <= sortnet::kMaxBlock) {
+            sortnet::sort_block(&*(a + lo), n);
+            return true;
+        }
+    }
+    insertion(a, lo, hi, comp);
+    return true;
+}
+
+inline void count_pivots(const Options& opt, long long k) {
+    if (opt.pivots) *opt.pivots += k;
+}
+
+// ----------------- Merge sort -----------------
+template <class It, class T, class Compare>
+void merge_sort_rec(It a, T* buf, std::size_t lo, std::size_t hi, Compare& comp, std::size_t leafSize) {
+    if (hi - lo < 2) return;
+    if (hi - lo <= leafSize) {
+        // a sorting network is unstable, but equal plain ints cannot be told apart;
+        // anything else gets insertion sort, which keeps the merge sort stable
+        if constexpr (network_leaf<It, Compare>) {
+            if (hi - lo <= sortnet::kMaxBlock) {
+                sortnet::sort_block(&*(a + lo), hi - lo);
+                return;
+            }
+        }
+        insertion(a, lo, hi, comp);
+        return;
+    }
+    std::size_t mid = lo + (hi - lo) / 2;
+    merge_sort_rec(a, buf, lo, mid, comp, leafSize);
+    merge_sort_rec(a, buf, mid, hi, comp, leafSize);
+    if (!comp(a[mid], a[mid - 1])) return;  // halves already in order
+
+    for (std::size_t i = lo; i < mid; ++i) buf[i - lo] = std::move(a[i]);
+    std::size_t i = 0, j = mid, k = lo, nl = mid - lo;
+    while (i < nl && j < hi)
+        a[k++] = comp(a[j], buf[i]) ? std::move(a[j++]) : std::move(buf[i++]);
+    while (i < nl) a[k++] = std::move(buf[i++]);
+}
+
+// ----------------- Quick sorts -----------------
+// Lomuto partition around the last element of [lo, hi)
+template <class It, class Compare>
+std::size_t partition(It a, std::size_t lo, std::size_t hi, Compare& comp) {
+    std::size_t last = hi - 1;
+    std::size_t i = lo;
+    for (std::size_t j = lo; j < last; ++j)
+        if (comp(a[j], a[last]))
+            std::swap(a[i++], a[j]);
+    std::swap(a[i], a[last]);
+    return i;
+}
+
+template <class It, class Compare>
+void quick_sort_rec(It a, std::size_t lo, std::size_t hi, Compare& comp, const Options& opt) {
+    // recurse into the smaller side, loop on the larger one: stack depth stays O(log n)
+    while (hi - lo > 1 && !leaf(a, lo, hi, comp, opt)) {
+        count_pivots(opt, 1);
+        std::size_t p = partition(a, lo, hi, comp);
+        if (p - lo < hi - p - 1) {
+            quick_sort_rec(a, lo, p, comp, opt);
+            lo = p + 1;
+        } else {
+            quick_sort_rec(a, p + 1, hi, comp, opt);
+            hi = p;
+        }
+    }
+}
+
+template <class It, class Compare>
+void quick_sort_dual_rec(It a, std::size_t lo, std::size_t hi, Compare& comp, const Options& opt) {
+    if (hi - lo < 2 || leaf(a, lo, hi, comp, opt)) return;
+    count_pivots(opt, 2);
+    std::size_t last = hi - 1;
+    if (comp(a[last], a[lo])) std::swap(a[lo], a[last]);
+
+    // a[lo] and a[last] stay put until the final swaps
+    std::size_t lt = lo + 1, gt = last - 1, i = lt;
+    while (i <= gt) {
+        if (comp(a[i], a[lo])) std::swap(a[i++], a[lt++]);
+        else if (comp(a[last], a[i])) std::swap(a[i], a[gt--]);
+        else i++;
+    }
+    std::swap(a[lo], a[--lt]);
+    std::swap(a[last], a[++gt]);
+
+    quick_sort_dual_rec(a, lo, lt, comp, opt);
+    quick_sort_dual_rec(a, lt + 1, gt, comp, opt);
+    quick_sort_dual_rec(a, gt + 1, hi, comp, opt);
+}
+
+template <class It, class Compare>
+void quick_sort_triple_rec(It a, std::size_t lo, std::size_t hi, Compare& comp, const Options& opt) {
+    if (hi - lo < 2 || leaf(a, lo, hi, comp, opt)) return;
+    if (hi - lo < 4) {
+        insertion(a, lo, hi, comp);
+        return;
+    }
+    count_pivots(opt, 3);
+    using T = value_t<It>;
+    std::size_t last = hi - 1;
+    std::size_t mid = lo + (hi - lo) / 2;
+
+    // order the three samples in place: a[lo] <= a[mid] <= a[last]
+    if (comp(a[mid], a[lo])) std::swap(a[mid], a[lo]);
+    if (comp(a[last], a[mid])) std::swap(a[last], a[mid]);
+    if (comp(a[mid], a[lo])) std::swap(a[mid], a[lo]);
+
+    T p1 = std::move(a[lo]), p2 = std::move(a[mid]), p3 = std::move(a[last]);
+    std::vector<T> left, middle, right, upper;
+    for (std::size_t i = lo + 1; i < last; i++) {
+        if (i == mid) continue;
+        if (comp(a[i], p1)) left.push_back(std::move(a[i]));
+        else if (comp(a[i], p2)) middle.push_back(std::move(a[i]));
+        else if (comp(a[i], p3)) right.push_back(std::move(a[i]));
+        else upper.push_back(std::move(a[i]));
+    }
+
+    std::size_t idx = lo;
+    auto emit = [&](std::vector<T>& part) -> std::size_t {
+        std::size_t start = idx;
+        for (auto& x : part) a[idx++] = std::move(x);
+        return start;
+    };
+    std::size_t l = emit(left);
+    a[idx++] = std::move(p1);
+    std::size_t m = emit(middle);
+    a[idx++] = std::move(p2);
+    std::size_t r = emit(right);
+    a[idx++] = std::move(p3);
+    std::size_t u = emit(upper);
+
+    quick_sort_triple_rec(a, l, l + left.size(), comp, opt);
+    quick_sort_triple_rec(a, m, m + middle.size(), comp, opt);
+    quick_sort_triple_rec(a, r, r + right.size(), comp, opt);
+    quick_sort_triple_rec(a, u, u + upper.size(), comp, opt);
+}
+
+} // namespace detail
+
+// ----------------- Public interface -----------------
+template <class RandomIt, class Compare = std::less<>>
+void bubble_sort(RandomIt first, RandomIt last, Compare comp = {}) {
+    std::size_t n = last - first;
+    for (std::size_t i = 0; i + 1 < n; i++)
+        for (std::size_t j = 0; j + i + 1 < n; j++)
+            if (comp(first[j + 1], first[j]))
+                std::swap(first[j], first[j + 1]);
+}
+
+template <class RandomIt, class Compare = std::less<>>
+void insertion_sort(RandomIt first, RandomIt last, Compare comp = {}) {
+    detail::insertion(first, 0, last - first, comp);
+}
+
+// Stable; runs of at most leaf elements are finished by the leaf sort (a
+// sorting network for ascending ints, insertion sort otherwise)
+template <class RandomIt, class Compare = std::less<>>
+void merge_sort(RandomIt first, RandomIt last, Compare comp = {}, std::size_t leaf = 0) {
+    std::size_t n = last - first;
+    if (n < 2) return;
+    std::vector<detail::value_t<RandomIt>> buf((n + 1) / 2);
+    detail::merge_sort_rec(first, buf.data(), 0, n, comp, leaf);
+}
+
+// Single pivot (last element)
+template <class RandomIt, class Compare = std::less<>>
+void quick_sort(RandomIt first, RandomIt last, Compare comp = {}, const Options& opt = {}) {
+    detail::quick_sort_rec(first, 0, last - first, comp, opt);
+}
+
+// Dual pivot (first and last element)
+template <class RandomIt, class Compare = std::less<>>
+void quick_sort_dual(RandomIt first, RandomIt last, Compare comp = {}, const Options& opt = {}) {
+    detail::quick_sort_dual_rec(first, 0, last - first, comp, opt);
+}
+
+// Triple pivot (first, middle and last element)
+template <class RandomIt, class Compare = std::less<>>
+void quick_sort_triple(RandomIt first, RandomIt last, Compare comp = {}, const Options& opt = {}) {
+    detail::quick_sort_triple_rec(first, 0, last - first, comp, opt);
+}
+
+} // namespace sortlib
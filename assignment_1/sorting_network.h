@@ -0,0 +1,202 @@
+// Bitonic sorting networks for small int arrays (8/16/32/64 elements)
+//
+// With AVX2 the whole block is kept in ymm registers (8 ints each) and every
+// compare-exchange stage is a permute + min + max + blend. Without AVX2 the
+// scalar network is about twice as slow as insertion sort on these sizes, so
+// sort_block (and the sortlib leaves, see kVectorized) use insertion sort.
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace sortnet {
+
+// Largest block sorted by a single network
+constexpr std::size_t kMaxBlock = 64;
+
+// True when the networks run in vector registers; only then do they beat insertion sort
+#if defined(__AVX2__)
+constexpr bool kVectorized = true;
+#else
+constexpr bool kVectorized = false;
+#endif
+
+inline void insertion_sort(int* a, std::size_t n) {
+    for (std::size_t i = 1; i < n; ++i) {
+        int key = a[i];
+        std::size_t j = i;
+        for (; j > 0 && key < a[j - 1]; --j) a[j] = a[j - 1];
+        a[j] = key;
+    }
+}
+
+// ----------------- Scalar network -----------------
+// n must be a power of two
+inline void bitonic_sort_scalar(int* a, std::size_t n) {
+    for (std::size_t k = 2; k <= n; k *= 2)
+        for (std::size_t j = k / 2; j > 0; j /= 2)
+            for (std::size_t i = 0; i < n; ++i) {
+                std::size_t l = i ^ j;
+                if (l <= i) continue;
+                int lo = std::min(a[i], a[l]);
+                int hi = std::max(a[i], a[l]);
+                bool asc = (i & k) == 0;
+                a[i] = asc ? lo : hi;
+                a[l] = asc ? hi : lo;
+            }
+}
+
+#if defined(__AVX2__)
+// ----------------- AVX2 network -----------------
+namespace detail {
+
+// Lanes i with (i & bit) != 0
+constexpr int lane_mask(int bit) {
+    int m = 0;
+    for (int i = 0; i < 8; ++i)
+        if (i & bit) m |= 1 << i;
+    return m;
+}
+
+// Swap lanes i and i ^ J inside one register
+template <int J>
+inline __m256i partner(__m256i x) {
+    if constexpr (J == 1) return _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1));
+    else if constexpr (J == 2) return _mm256_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2));
+    else return _mm256_permute2x128_si256(x, x, 0x01);
+}
+
+// Compare-exchange of lanes J apart; lanes in MaxMask keep the larger value
+template <int J, int MaxMask>
+inline __m256i exchange_in_register(__m256i x) {
+    __m256i p = partner<J>(x);
+    return _mm256_blend_epi32(_mm256_min_epi32(x, p), _mm256_max_epi32(x, p), MaxMask);
+}
+
+// One (K, J) stage of the bitonic network over R registers
+template <int R, int K, int J>
+inline void stage(__m256i* v) {
+    if constexpr (J >= 8) {
+        constexpr int d = J / 8;
+        for (int r = 0; r < R; ++r) {
+            if ((r & d) != 0) continue;
+            __m256i lo = _mm256_min_epi32(v[r], v[r + d]);
+            __m256i hi = _mm256_max_epi32(v[r], v[r + d]);
+            bool asc = ((r * 8) & K) == 0;
+            v[r] = asc ? lo : hi;
+            v[r + d] = asc ? hi : lo;
+        }
+    } else if constexpr (K < 8) {
+        // direction changes inside the register
+        constexpr int maxMask = lane_mask(J) ^ lane_mask(K);
+        for (int r = 0; r < R; ++r)
+            v[r] = exchange_in_register<J, maxMask>(v[r]);
+    } else {
+        // direction is fixed per register
+        constexpr int ascMask = lane_mask(J);
+        for (int r = 0; r < R; ++r) {
+            if (((r * 8) & K) == 0) v[r] = exchange_in_register<J, ascMask>(v[r]);
+            else v[r] = exchange_in_register<J, ascMask ^ 0xFF>(v[r]);
+        }
+    }
+}
+
+template <int R, int K, int J>
+inline void merge_steps(__m256i* v) {
+    stage<R, K, J>(v);
+    if constexpr (J > 1) merge_steps<R, K, J / 2>(v);
+}
+
+template <int R, int K>
+inline void passes(__m256i* v) {
+    merge_steps<R, K, K / 2>(v);
+    if constexpr (K < 8 * R) passes<R, K * 2>(v);
+}
+
+template <int R>
+inline void sort_registers(int* a) {
+    __m256i v[R];
+    for (int r = 0; r < R; ++r)
+        v[r] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + 8 * r));
+    passes<R, 2>(v);
+    for (int r = 0; r < R; ++r)
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(a + 8 * r), v[r]);
+}
+
+} // namespace detail
+
+inline void sort8(int* a)  { detail::sort_registers<1>(a); }
+inline void sort16(int* a) { detail::sort_registers<2>(a); }
+inline void sort32(int* a) { detail::sort_registers<4>(a); }
+inline void sort64(int* a) { detail::sort_registers<8>(a); }
+#else
+inline void sort8(int* a)  { bitonic_sort_scalar(a, 8); }
+inline void sort16(int* a) { bitonic_sort_scalar(a, 16); }
+inline void sort32(int* a) { bitonic_sort_scalar(a, 32); }
+inline void sort64(int* a) { bitonic_sort_scalar(a, 64); }
+#endif
+
+// ----------------- Leaf sort -----------------
+// Sorts n <= kMaxBlock ints: pads up to the next network size with INT_MAX.
+// Larger n, and every n without AVX2, go to insertion sort.
+inline void sort_block(int* a, std::size_t n) {
+    if (!kVectorized || n > kMaxBlock) {
+        insertion_sort(a, n);
+        return;
+    }
+    if (n < 2) return;
+    if (n == 2) {
+        if (a[1] < a[0]) std::swap(a[0], a[1]);
+        return;
+    }
+
+    std::size_t block = 8;
+    while (block < n) block *= 2;
+
+    alignas(32) int buf[kMaxBlock];
+    std::copy(a, a + n, buf);
+    std::fill(buf + n, buf + block, INT_MAX);
+
+    switch (block) {
+        case 8:  sort8(buf); break;
+        case 16: sort16(buf); break;
+        case 32: sort32(buf); break;
+        default: sort64(buf); break;
+    }
+    std::copy(buf, buf + n, a);
+}
+
+// ----------------- Standalone small-array sort -----------------
+// Network-sorts 64-element blocks, then merges them bottom-up
+inline void small_sort(int* a, std::size_t n) {
+    if (n <= kMaxBlock) {
+        sort_block(a, n);
+        return;
+    }
+
+    for (std::size_t i = 0; i < n; i += kMaxBlock)
+        sort_block(a + i, std::min(kMaxBlock, n - i));
+
+    std::vector<int> tmp(n);
+    int* src = a;
+    int* dst = tmp.data();
+    for (std::size_t width = kMaxBlock; width < n; width *= 2) {
+        for (std::size_t lo = 0; lo < n; lo += 2 * width) {
+            std::size_t mid = std::min(lo + width, n);
+            std::size_t hi = std::min(lo + 2 * width, n);
+            std::merge(src + lo, src + mid, src + mid, src + hi, dst + lo);
+        }
+        std::swap(src, dst);
+    }
+    if (src != a) std::copy(src, src + n, a);
+}
+
+inline void small_sort(std::vector<int>& arr) { small_sort(arr.data(), arr.size()); }
+
+} // namespace sortnet
@@ -1,147 +1,166 @@
 // Testing the execution time of algorithms depending on array sizes
 #include <iostream>
 #include <vector>
-#include <chrono>
 #include <functional>
 #include <cstdlib>
 #include <ctime>
-#include <fstream>
 #include <iomanip>
+#include <cstdint>
+#include <random>
+#include <algorithm>
+#include <string>
+#include "sort_lib.h"
+#include "radix_sort.h"
+#include "../common/bench.h"
+#include "../common/input_gen.h"
 
 using namespace std;
-using namespace chrono;
 
 
-// Bubble sort
-void bubbleSort(vector<int>& arr) {
-    int n = arr.size();
-    for (int i = 0; i < n - 1; i++)
-        for (int j = 0; j < n - i - 1; j++)
-            if (arr[j] > arr[j + 1])
-                swap(arr[j], arr[j + 1]);
-}
+// Sorts from sort_lib.h
+void bubbleSort(vector<int>& arr)    { sortlib::bubble_sort(arr.begin(), arr.end()); }
+void insertionSort(vector<int>& arr) { sortlib::insertion_sort(arr.begin(), arr.end()); }
+void mergeSort(vector<int>& arr)     { sortlib::merge_sort(arr.begin(), arr.end()); }
+void quickSort(vector<int>& arr)     { sortlib::quick_sort(arr.begin(), arr.end()); }
 
-// Insertion sort
-void insertionSort(vector<int>& arr) {
-    int n = arr.size();
-    for (int i = 1; i < n; i++) {
-        int key = arr[i];
-        int j = i - 1;
-        while (j >= 0 && arr[j] > key) {
-            arr[j + 1] = arr[j];
-            j--;
-        }
-        arr[j + 1] = key;
-    }
-}
 
-// Merge sort helper
-void merge(vector<int>& arr, int left, int mid, int right) {
-    vector<int> L(arr.begin() + left, arr.begin() + mid + 1);
-    vector<int> R(arr.begin() + mid + 1, arr.begin() + right + 1);
+// antiqsort targets: the same sorts on an index array, with the adversary's comparator
+auto bubbleTarget    = [](vector<int>& v, auto less){ sortlib::bubble_sort(v.begin(), v.end(), less); };
+auto insertionTarget = [](vector<int>& v, auto less){ sortlib::insertion_sort(v.begin(), v.end(), less); };
+auto mergeTarget     = [](vector<int>& v, auto less){ sortlib::merge_sort(v.begin(), v.end(), less); };
+auto quickTarget     = [](vector<int>& v, auto less){ sortlib::quick_sort(v.begin(), v.end(), less); };
+auto stdTarget       = [](vector<int>& v, auto less){ sort(v.begin(), v.end(), less); };
 
-    int i = 0, j = 0, k = left;
-    while (i < L.size() && j < R.size())
-        arr[k++] = (L[i] <= R[j]) ? L[i++] : R[j++];
-    while (i < L.size()) arr[k++] = L[i++];
-    while (j < R.size()) arr[k++] = R[j++];
-}
+unsigned long long seed = 1;
 
-// Merge sort
-void mergeSort(vector<int>& arr, int left, int right) {
-    if (left >= right) return;
-    int mid = (left + right) / 2;
-    mergeSort(arr, left, mid);
-    mergeSort(arr, mid + 1, right);
-    merge(arr, left, mid, right);
+// Seeded input of one distribution; an antiqsort input is aimed at target
+template<typename Target>
+vector<int> generateArray(inputgen::Dist d, int n, Target target){
+    return inputgen::generate(d, n, seed, target);
 }
 
-// Quick sort helper
-int partition(vector<int>& arr, int low, int high) {
-    int pivot = arr[high];
-    int i = low - 1;
-    for (int j = low; j < high; j++)
-        if (arr[j] < pivot)
-            swap(arr[++i], arr[j]);
-    swap(arr[i + 1], arr[high]);
-    return i + 1;
+// Small arrays are too fast to time alone: time a batch of copies, reported per sort
+double measureBatch(bench::Suite& suite, const string& name, const string& dist, function<void(vector<int>&)> f,
+                    const vector<int>& arr, size_t batch){
+    return suite.run({name, arr.size(), "dist=" + dist, batch},
+                     [&]{ return vector<vector<int>>(batch, arr); },
+                     [&](vector<vector<int>>& copies){ for(auto& c : copies) f(c); }).stats.median;
 }
 
-// Quick sort
-void quickSort(vector<int>& arr, int low, int high) {
-    if (low < high) {
-        int p = partition(arr, low, high);
-        quickSort(arr, low, p - 1);
-        quickSort(arr, p + 1, high);
-    }
+// Measure execution time of one sort on a fresh copy of arr; arrays below
+// kBatchBelow elements are timed in batches, one sort being under the clock's resolution
+const size_t kBatchBelow = 1000;
+
+double measure(bench::Suite& suite, const string& name, const string& dist,
+               function<void(vector<int>&)> f, const vector<int>& arr){
+    if (arr.size() < kBatchBelow) return measureBatch(suite, name, dist, f, arr, kBatchBelow / max<size_t>(1, arr.size()));
+    return suite.run({name, arr.size(), "dist=" + dist}, [&]{ return arr; }, f).stats.median;
 }
 
+// Small arrays: insertion sort vs. sorting network
+void smallSortStudy(bench::Suite& suite, const vector<inputgen::Dist>& dists, int precision){
+    vector<int> sizes={1,2,4,8,12,16,24,32,48,64,96,128};
+    const size_t batch=10000;
 
+    for(auto d : dists){
+        const string dist = inputgen::name(d);
+        cout << "Small arrays (n <= 128), " << dist << ", median per sort:" << endl;
 
+        for(int n : sizes){
+            vector<int> base=generateArray(d, n, insertionTarget);
+            double i_med = measureBatch(suite, "small_insertion", dist, insertionSort, base, batch);
+            double s_med = measureBatch(suite, "small_network", dist, [](vector<int>& v){ sortnet::small_sort(v); }, base, batch);
+
+            cout << "n=" << setw(4) << n
+                 << "  Insertion: " << scientific << setprecision(precision) << i_med << " s"
+                 << "  Network: " << scientific << setprecision(precision) << s_med << " s" << endl;
+        }
+    }
+}
 
-// Generate random array
-vector<int> generateArray(int n){
-    vector<int> arr(n);
-    for(int i=0;i<n;i++) arr[i]=rand()%10000;
-    return arr;
+// Large arrays: comparison sorts vs. radix sorts, for int, uint64 and key/value pairs
+template<typename T>
+void largeSortRow(bench::Suite& suite, const string& type, const string& dist, const vector<T>& base){
+    size_t n = base.size();
+    auto time = [&](const string& name, auto sort){
+        return suite.run({name, n, type + ";dist=" + dist}, [&]{ return base; }, sort).stats.median;
+    };
+    auto byKey = [](const T& a, const T& b){ if constexpr (is_integral_v<T>) return a < b; else return a.first < b.first; };
+
+    double tMerge = time("merge_sort", [&](vector<T>& v){ sortlib::merge_sort(v.begin(), v.end(), byKey); });
+    double tStd   = time("std_sort", [&](vector<T>& v){ sort(v.begin(), v.end(), byKey); });
+    double tLsd8  = time("lsd8", [](vector<T>& v){ radix::lsd_sort<8>(v); });
+    double tLsd11 = time("lsd11", [](vector<T>& v){ radix::lsd_sort<11>(v); });
+    double tMsd   = time("msd", [](vector<T>& v){ radix::msd_sort(v); });
+
+    cout << setw(10) << type << setw(12) << dist << setw(11) << n << fixed << setprecision(6)
+         << setw(12) << tMerge << setw(12) << tStd << setw(12) << tLsd8
+         << setw(12) << tLsd11 << setw(12) << tMsd << endl;
 }
 
-// Measure execution time
-double measure(function<void(vector<int>&)> f, vector<int> arr){
-    auto start=high_resolution_clock::now();
-    f(arr);
-    auto end=high_resolution_clock::now();
-    return chrono::duration_cast<chrono::duration<double>>(end-start).count();
+// int32 rows run every distribution (antiqsort aimed at std::sort); uint64 and key/value stay random
+void largeSortStudy(bench::Suite& suite, const vector<inputgen::Dist>& dists, size_t maxN){
+    vector<size_t> sizes={1000,10000,100000,1'000'000,10'000'000,100'000'000};
+    const size_t antiqsortMaxN = 1'000'000;  // building the adversary runs std::sort with a stateful comparator
+    mt19937_64 gen(seed);
+
+    cout << "Large arrays, comparison vs. radix sorts (median):" << endl;
+    cout << setw(10) << "type" << setw(12) << "dist" << setw(11) << "n" << setw(12) << "Merge" << setw(12) << "std::sort"
+         << setw(12) << "LSD8" << setw(12) << "LSD11" << setw(12) << "MSD" << endl;
+
+    for(size_t n : sizes){
+        if(n > maxN) break;
+        for(auto d : dists){
+            if(d == inputgen::Dist::AntiQsort && n > antiqsortMaxN) continue;
+            largeSortRow<int>(suite, "int32", inputgen::name(d), generateArray(d, n, stdTarget));
+        }
+
+        vector<uint64_t> wide(n);
+        for(auto& x : wide) x = gen();
+        largeSortRow<uint64_t>(suite, "uint64", "random", wide);
+        vector<pair<uint32_t,uint32_t>> kv(n);
+        for(size_t i = 0; i < n; ++i) kv[i] = {uint32_t(gen()), uint32_t(i)};
+        largeSortRow<pair<uint32_t,uint32_t>>(suite, "key/value", "random", kv);
+    }
+    cout << defaultfloat;
 }
 
 //main
-int main(){
-    srand(time(nullptr));
+int main(int argc, char** argv){
+    bench::Suite suite("test_algorithms", bench::parse_args(argc, argv));
+    // --dist LIST: input distributions (default all, see input_gen.h)
+    auto dists = inputgen::parse_args(argc, argv);
+    // optional argument: largest size for the radix study (default 100M)
+    size_t maxN = argc > 1 ? stoull(argv[1]) : 100'000'000;
+    seed = suite.config().seed;
 
     vector<int> sizes={1,5,10,25,50,100,300,500,1000,2000};
-    const int runs=5;
-
-    ofstream csv("sorting_results.csv");
-    csv << "n,Bubble,Insertion,Merge,Quick\n";
 
     // fixed number of digits
     const int precision = 17;
 
-    for(int n : sizes){
-        double b_sum=0,i_sum=0,m_sum=0,q_sum=0;
-
-        for(int r=0;r<runs;r++){
-            vector<int> base=generateArray(n);
-
-            b_sum += measure(bubbleSort, base);
-            i_sum += measure(insertionSort, base);
-            m_sum += measure([&](vector<int>& v){ if(!v.empty()) mergeSort(v,0,v.size()-1); }, base);
-            q_sum += measure([&](vector<int>& v){ if(!v.empty()) quickSort(v,0,v.size()-1); }, base);
+    for(auto d : dists){
+        const string dist = inputgen::name(d);
+        for(int n : sizes){
+            // each sort gets its own adversary; every other distribution is one shared input
+            double b_med = measure(suite, "bubble", dist, bubbleSort, generateArray(d, n, bubbleTarget));
+            double i_med = measure(suite, "insertion", dist, insertionSort, generateArray(d, n, insertionTarget));
+            double m_med = measure(suite, "merge", dist, mergeSort, generateArray(d, n, mergeTarget));
+            double q_med = measure(suite, "quick", dist, quickSort, generateArray(d, n, quickTarget));
+
+            // print
+            cout << "Array size: " << n << " (" << dist << ")" << endl;
+            cout << "Bubble:    " << scientific << setprecision(precision) << b_med << " s" << endl;
+            cout << "Insertion: " << scientific << setprecision(precision) << i_med << " s" << endl;
+            cout << "Merge:     " << scientific << setprecision(precision) << m_med << " s" << endl;
+            cout << "Quick:     " << scientific << setprecision(precision) << q_med << " s" << endl;
+            cout << "---------------------------------" << endl;
         }
-
-        double b_avg=b_sum/runs;
-        double i_avg=i_sum/runs;
-        double m_avg=m_sum/runs;
-        double q_avg=q_sum/runs;
-
-        // write row to CSV
-        csv << n << ","
-            << scientific << setprecision(precision) << b_avg << ","
-            << scientific << setprecision(precision) << i_avg << ","
-            << scientific << setprecision(precision) << m_avg << ","
-            << scientific << setprecision(precision) << q_avg << "\n";
-
-        // print
-        cout << "Array size: " << n << endl;
-        cout << "Bubble:    " << scientific << setprecision(precision) << b_avg << " s" << endl;
-        cout << "Insertion: " << scientific << setprecision(precision) << i_avg << " s" << endl;
-        cout << "Merge:     " << scientific << setprecision(precision) << m_avg << " s" << endl;
-        cout << "Quick:     " << scientific << setprecision(precision) << q_avg << " s" << endl;
-        cout << "---------------------------------" << endl;
     }
 
-    csv.close();
-    cout << "CSV file 'sorting_results.csv' created successfully!" << endl;
+    smallSortStudy(suite, dists, precision);
+    largeSortStudy(suite, dists, maxN);
 
+    suite.write();
     return 0;
 }
@@ -1,10 +1,15 @@
 // C++ Vector test
 #include <iostream>
 #include <vector>
-#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include "../common/bench.h"
 
 using namespace std;
 
+// Print every reallocation; switched off while timing
+bool traceRealloc = true;
+
 class MyVector {
 private:
     int* data;
@@ -20,11 +25,14 @@ private:
         data = newData;
         cap = newCap;
 
-        cout << "[MyVector] realloc to " << cap << "\n";
+        if (traceRealloc)
+            cout << "[MyVector] realloc to " << cap << "\n";
     }
 
 public:
     MyVector() : data(nullptr), sz(0), cap(0) {}
+    MyVector(const MyVector&) = delete;
+    MyVector& operator=(const MyVector&) = delete;
     ~MyVector() { delete[] data; }
 
     void push_back(int value) {
@@ -49,6 +57,8 @@ private:
 
 public:
     LinkedList() : head(nullptr), tail(nullptr) {}
+    LinkedList(const LinkedList&) = delete;
+    LinkedList& operator=(const LinkedList&) = delete;
 
     ~LinkedList() {
         while (head) {
@@ -69,26 +79,33 @@ public:
     }
 };
 
-// Benchmarks
-void test_myvector(size_t N) {
-    MyVector v;
-    auto start = chrono::high_resolution_clock::now();
-
-    for (size_t i = 0; i < N; ++i)
-        v.push_back(i);
+// Heap use next to the timing, in builds that track allocations (BENCH_TRACK_ALLOC)
+string memoryNote(const bench::Result& r) {
+    const auto& m = r.memory;
+    if (!m.valid) return "";
+    ostringstream note;
+    note << ", peak heap " << (long long)m.peak_bytes << " B (" << setprecision(3) << m.peak_bytes / r.n
+         << " B/elem), " << (long long)m.allocs << " allocs";
+    return note.str();
+}
 
-    auto end = chrono::high_resolution_clock::now();
-    cout << "MyVector time: "
-         << chrono::duration<double>(end - start).count()
-         << " s\n\n";
+// Benchmarks: one traced pass printing reallocations, then the timed runs. The
+// container comes from the setup, so its destruction is not timed.
+void test_myvector(bench::Suite& suite, size_t N) {
+    traceRealloc = true;
+    { MyVector v; for (size_t i = 0; i < N; ++i) v.push_back(i); }
+    traceRealloc = false;
+
+    auto& r = suite.run({"myvector_push_back", N}, [] { return MyVector(); }, [&](MyVector& v) {
+        for (size_t i = 0; i < N; ++i)
+            v.push_back(i);
+    });
+    cout << "MyVector time: " << r.stats.median << " s" << memoryNote(r) << "\n\n";
 }
 
-void test_stdvector(size_t N) {
+void test_stdvector(bench::Suite& suite, size_t N) {
     vector<int> v;
     size_t lastCap = v.capacity();
-
-    auto start = chrono::high_resolution_clock::now();
-
     for (size_t i = 0; i < N; ++i) {
         v.push_back(i);
         if (v.capacity() != lastCap) {
@@ -98,36 +115,33 @@ void test_stdvector(size_t N) {
         }
     }
 
-    auto end = chrono::high_resolution_clock::now();
-    cout << "std::vector time: "
-         << chrono::duration<double>(end - start).count()
-         << " s\n\n";
+    auto& r = suite.run({"stdvector_push_back", N}, [] { return vector<int>(); }, [&](vector<int>& v) {
+        for (size_t i = 0; i < N; ++i)
+            v.push_back(i);
+    });
+    cout << "std::vector time: " << r.stats.median << " s" << memoryNote(r) << "\n\n";
 }
 
-void test_linkedlist(size_t N) {
-    LinkedList list;
-    auto start = chrono::high_resolution_clock::now();
-
-    for (size_t i = 0; i < N; ++i)
-        list.push_back(i);
-
-    auto end = chrono::high_resolution_clock::now();
-    cout << "LinkedList time: "
-         << chrono::duration<double>(end - start).count()
-         << " s\n\n";
+void test_linkedlist(bench::Suite& suite, size_t N) {
+    auto& r = suite.run({"linkedlist_push_back", N}, [] { return LinkedList(); }, [&](LinkedList& list) {
+        for (size_t i = 0; i < N; ++i)
+            list.push_back(i);
+    });
+    cout << "LinkedList time: " << r.stats.median << " s" << memoryNote(r) << "\n\n";
 }
 
-int main() {
+int main(int argc, char** argv) {
+    bench::Suite suite("test_vector", bench::parse_args(argc, argv));
     const size_t N = 5'000'000;
 
     cout << "=== Testing MyVector ===\n";
-    test_myvector(N);
+    test_myvector(suite, N);
 
     cout << "=== Testing std::vector ===\n";
-    test_stdvector(N);
+    test_stdvector(suite, N);
 
     cout << "=== Testing LinkedList ===\n";
-    test_linkedlist(N);
+    test_linkedlist(suite, N);
 
     return 0;
 }
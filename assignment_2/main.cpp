@@ -2,13 +2,66 @@
 #include <vector>
 #include <set>
 #include <algorithm>
-#include <chrono>
 #include <random>
 #include <numeric>
 #include <functional>
+#include <string>
+#include <iterator>
+#include <stdexcept>
+#include <sstream>
+#include <iomanip>
+#include "../common/bench.h"
+#include "../common/input_gen.h"
 
 using namespace std;
-using namespace chrono;
+
+// ----------------- LOOKUPS ----------------------
+// Shared by the binary-search trees whose nodes have key/left/right
+
+inline void prefetchNode(const void* p) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(p);
+#else
+    (void)p;
+#endif
+}
+
+template <class Node>
+Node* findIn(Node* node, int key) {
+    while (node && node->key != key) node = key < node->key ? node->left : node->right;
+    return node;
+}
+
+// out[i] = a node holding keys[i], or nullptr. Group prefetching: kFindGroup
+// lookups are in flight, and each round moves every one of them down a level
+// and prefetches the node it lands on. The cache misses of different keys then
+// overlap instead of stalling the CPU one level at a time; a finished lookup
+// hands its slot to the next key.
+constexpr size_t kFindGroup = 16;
+
+template <class Node>
+void findManyIn(Node* root, const int* keys, size_t count, Node** out) {
+    Node* cur[kFindGroup];
+    size_t idx[kFindGroup];
+    size_t next = 0, active = 0;
+    if (!root) { fill(out, out + count, nullptr); return; }
+    for (; active < kFindGroup && next < count; ++active) { cur[active] = root; idx[active] = next++; }
+    while (active) {
+        for (size_t s = 0; s < active;) {
+            Node* node = cur[s];
+            int key = keys[idx[s]];
+            Node* child = key < node->key ? node->left : node->right;
+            if (key != node->key && child) {
+                prefetchNode(child);
+                cur[s++] = child;
+                continue;
+            }
+            out[idx[s]] = key == node->key ? node : nullptr;
+            if (next < count) { cur[s] = root; idx[s++] = next++; }
+            else { --active; cur[s] = cur[active]; idx[s] = idx[active]; }
+        }
+    }
+}
 
 struct BinaryNode {
     int key;
@@ -23,6 +76,9 @@ public:
     void insert(int key) { root = insertRec(root, key); }
     void remove(int key) { root = removeRec(root, key); }
     int height() { return heightRec(root); }
+    BinaryNode* find(int key) { return findIn(root, key); }
+    // out[i] = find(keys[i]), with the lookups interleaved (see findManyIn)
+    void findMany(const int* keys, size_t count, BinaryNode** out) { findManyIn(root, keys, count, out); }
 
 private:
     BinaryNode* insertRec(BinaryNode* node, int key) {
@@ -92,7 +148,8 @@ struct AVLNode {
     AVLNode* left;
     AVLNode* right;
     int height;
-    AVLNode(int k) : key(k), left(nullptr), right(nullptr), height(1) {}
+    int size;  // nodes in this subtree
+    AVLNode(int k) : key(k), left(nullptr), right(nullptr), height(1), size(1) {}
 };
 
 class AVLTree {
@@ -100,9 +157,52 @@ public:
     AVLNode* root = nullptr;
     void insert(int key) { root = insertRec(root, key); }
     int height() { return root ? root->height : 0; }
+    int size() { return getSize(root); }
+    AVLNode* find(int key) { return findIn(root, key); }
+    // out[i] = find(keys[i]), with the lookups interleaved (see findManyIn)
+    void findMany(const int* keys, size_t count, AVLNode** out) { findManyIn(root, keys, count, out); }
+
+    // Number of keys <= x, O(log N)
+    int rank(int x) {
+        int r = 0;
+        for (AVLNode* node = root; node;) {
+            if (x < node->key) node = node->left;
+            else { r += getSize(node->left) + 1; node = node->right; }
+        }
+        return r;
+    }
+
+    // k-th smallest key, k = 1..size(), O(log N)
+    int select(int k) {
+        if (k < 1 || k > size()) throw out_of_range("AVLTree::select");
+        AVLNode* node = root;
+        for (;;) {
+            int leftSize = getSize(node->left);
+            if (k <= leftSize) node = node->left;
+            else if (k == leftSize + 1) return node->key;
+            else { k -= leftSize + 1; node = node->right; }
+        }
+    }
+
+    // Number of keys in [lo, hi], O(log N)
+    int countRange(int lo, int hi) { return lo > hi ? 0 : rank(hi) - countLess(lo); }
 
 private:
     int getHeight(AVLNode* node) { return node ? node->height : 0; }
+    int getSize(AVLNode* node) { return node ? node->size : 0; }
+    void update(AVLNode* node) {
+        node->height = 1 + max(getHeight(node->left), getHeight(node->right));
+        node->size = 1 + getSize(node->left) + getSize(node->right);
+    }
+
+    int countLess(int x) {
+        int r = 0;
+        for (AVLNode* node = root; node;) {
+            if (node->key < x) { r += getSize(node->left) + 1; node = node->right; }
+            else node = node->left;
+        }
+        return r;
+    }
     int getBalance(AVLNode* node) { return node ? getHeight(node->left) - getHeight(node->right) : 0; }
 
     AVLNode* rightRotate(AVLNode* y) {
@@ -110,8 +210,8 @@ private:
         AVLNode* T2 = x->right;
         x->right = y;
         y->left = T2;
-        y->height = 1 + max(getHeight(y->left), getHeight(y->right));
-        x->height = 1 + max(getHeight(x->left), getHeight(x->right));
+        update(y);
+        update(x);
         return x;
     }
 
@@ -120,8 +220,8 @@ private:
         AVLNode* T2 = y->left;
         y->left = x;
         x->right = T2;
-        x->height = 1 + max(getHeight(x->left), getHeight(x->right));
-        y->height = 1 + max(getHeight(y->left), getHeight(y->right));
+        update(x);
+        update(y);
         return y;
     }
 
@@ -130,13 +230,18 @@ private:
         if (key < node->key) node->left = insertRec(node->left, key);
         else node->right = insertRec(node->right, key);
 
-        node->height = 1 + max(getHeight(node->left), getHeight(node->right));
+        update(node);
         int balance = getBalance(node);
 
-        if (balance > 1 && key < node->left->key) return rightRotate(node);
-        if (balance < -1 && key > node->right->key) return leftRotate(node);
-        if (balance > 1 && key > node->left->key) { node->left = leftRotate(node->left); return rightRotate(node); }
-        if (balance < -1 && key < node->right->key) { node->right = rightRotate(node->right); return leftRotate(node); }
+        // decided by the child's balance, not by comparing keys, so equal keys rebalance too
+        if (balance > 1) {
+            if (getBalance(node->left) < 0) node->left = leftRotate(node->left);
+            return rightRotate(node);
+        }
+        if (balance < -1) {
+            if (getBalance(node->right) > 0) node->right = rightRotate(node->right);
+            return leftRotate(node);
+        }
 
         return node;
     }
@@ -144,12 +249,10 @@ private:
 
 // ----------------- HELPERS ----------------------
 
-vector<int> generateRandomKeys(int n) {
-    vector<int> keys(n);
-    iota(keys.begin(), keys.end(), 1);
-    random_device rd;
-    mt19937 g(rd());
-    shuffle(keys.begin(), keys.end(), g);
+// Keys 1..n in the order of a seeded input distribution (see input_gen.h)
+vector<int> generateKeys(inputgen::Dist d, int n, unsigned long long seed) {
+    vector<int> keys = inputgen::generate(d, n, seed);
+    for (int& k : keys) ++k;
     return keys;
 }
 
@@ -168,60 +271,232 @@ vector<int> buildPerfectOrder(vector<int> keys) {
 }
 
 
-long long median(vector<long long> v) {
-    sort(v.begin(), v.end());
-    return v[v.size()/2];
-}
+struct InsertResult {
+    long long time;        // median, microseconds
+    int height;            // of the last tree built
+    bench::Memory memory;  // heap use of the last tree, if allocations are tracked
+};
 
+// Median insert time plus the height of the last tree built
 template<typename TreeType>
-pair<long long,int> measureInsertMedian(const vector<int>& keys, int runs) {
-    vector<long long> times;
+InsertResult measureInsertMedian(bench::Suite& suite, const string& name, const string& order,
+                                 const vector<int>& keys) {
     int h = 0;
-    for(int i=0;i<runs;i++){
+    auto& r = suite.run({name, keys.size(), order}, [&]{
         TreeType tree;
-        auto start = high_resolution_clock::now();
         for(int k: keys) tree.insert(k);
-        auto end = high_resolution_clock::now();
-        times.push_back(duration_cast<microseconds>(end-start).count());
         h = tree.height();
+        bench::do_not_optimize(tree.root);
+    });
+    r.metric("height", h);
+    return {(long long)(r.stats.median * 1e6), h, r.memory};
+}
+
+// Bytes per key and leaked bytes, in builds that track allocations (BENCH_TRACK_ALLOC)
+string memoryNote(const bench::Memory& m, size_t n) {
+    if (!m.valid) return "";
+    ostringstream note;
+    note << ", " << setprecision(3) << m.bytes / n << " B/key, leaked " << (long long)m.leaked_bytes << " B";
+    return note.str();
+}
+
+// ----------------- ORDER STATISTICS ----------------------
+// rank / select / range count on the size-augmented AVLTree, against binary
+// search on a sorted vector and std::set with std::distance / std::next
+struct Queries {
+    vector<int> x, k, lo, hi;
+};
+
+Queries makeQueries(int n, int count, mt19937& g) {
+    Queries q;
+    uniform_int_distribution<int> key(0, n + 1), pos(1, n), width(0, max(1, n / 100));
+    for (int i = 0; i < count; ++i) {
+        q.x.push_back(key(g));
+        q.k.push_back(pos(g));
+        q.lo.push_back(key(g));
+        q.hi.push_back(q.lo.back() + width(g));
+    }
+    return q;
+}
+
+// Runs count queries of one kind as a batch; returns ns per query and the checksum of the answers
+template <class F>
+pair<double, long long> measureQueries(bench::Suite& suite, const string& name, const string& structure,
+                                       int n, int count, F query) {
+    long long sum = 0;
+    auto& r = suite.run({name, size_t(n), structure, size_t(count)}, [&]{
+        sum = 0;
+        for (int i = 0; i < count; ++i) sum += query(i);
+        bench::do_not_optimize(sum);
+    });
+    return {r.stats.median * 1e9, sum};
+}
+
+void orderStatisticsStudy(bench::Suite& suite) {
+    const unsigned long long seed = suite.config().seed;
+    mt19937 g(seed);
+    cout << "\nOrder statistics (ns per query):\n";
+    cout << "N\tRank AVL/vector/set\t\tSelect AVL/vector/set\t\tRange AVL/vector/set\n";
+    for (int n : {1 << 10, 1 << 16, 1 << 20}) {
+        auto keys = generateKeys(inputgen::Dist::Random, n, seed);
+        AVLTree avl;
+        for (int k : keys) avl.insert(k);
+        vector<int> sorted(keys);
+        sort(sorted.begin(), sorted.end());
+        set<int> s(keys.begin(), keys.end());
+
+        const int count = 1 << 18;
+        const int setCount = max(1, min(count, (1 << 22) / n));  // std::distance walks the set: O(N) per query
+        Queries q = makeQueries(n, count, g);
+
+        auto vecRank = [&](int i) { return int(upper_bound(sorted.begin(), sorted.end(), q.x[i]) - sorted.begin()); };
+        auto vecRange = [&](int i) {
+            return int(upper_bound(sorted.begin(), sorted.end(), q.hi[i]) - lower_bound(sorted.begin(), sorted.end(), q.lo[i]));
+        };
+
+        auto rankAvl = measureQueries(suite, "rank", "avl", n, count, [&](int i) { return avl.rank(q.x[i]); });
+        auto rankVec = measureQueries(suite, "rank", "sorted_vector", n, count, vecRank);
+        auto rankSet = measureQueries(suite, "rank", "set", n, setCount, [&](int i) {
+            return int(distance(s.begin(), s.upper_bound(q.x[i])));
+        });
+
+        auto selAvl = measureQueries(suite, "select", "avl", n, count, [&](int i) { return avl.select(q.k[i]); });
+        auto selVec = measureQueries(suite, "select", "sorted_vector", n, count, [&](int i) { return sorted[q.k[i] - 1]; });
+        auto selSet = measureQueries(suite, "select", "set", n, setCount, [&](int i) {
+            return *next(s.begin(), q.k[i] - 1);
+        });
+
+        auto rangeAvl = measureQueries(suite, "count_range", "avl", n, count, [&](int i) {
+            return avl.countRange(q.lo[i], q.hi[i]);
+        });
+        auto rangeVec = measureQueries(suite, "count_range", "sorted_vector", n, count, vecRange);
+        auto rangeSet = measureQueries(suite, "count_range", "set", n, setCount, [&](int i) {
+            return int(distance(s.lower_bound(q.lo[i]), s.upper_bound(q.hi[i])));
+        });
+
+        // the AVL answers must match binary search on the sorted keys
+        long long expRank = 0, expSelSet = 0, expRangeSet = 0, expRankSet = 0;
+        for (int i = 0; i < setCount; ++i) {
+            expRankSet += vecRank(i);
+            expSelSet += sorted[q.k[i] - 1];
+            expRangeSet += vecRange(i);
+        }
+        for (int i = 0; i < count; ++i) expRank += vecRank(i);
+        bool ok = rankAvl.second == expRank && selAvl.second == selVec.second && rangeAvl.second == rangeVec.second &&
+                  rankSet.second == expRankSet && selSet.second == expSelSet && rangeSet.second == expRangeSet &&
+                  avl.size() == n;
+
+        cout << n << "\t" << rankAvl.first << "/" << rankVec.first << "/" << rankSet.first << "\t\t"
+             << selAvl.first << "/" << selVec.first << "/" << selSet.first << "\t\t"
+             << rangeAvl.first << "/" << rangeVec.first << "/" << rangeSet.first
+             << (ok ? "" : "\tMISMATCH") << "\n";
     }
-    return {median(times), h};
 }
 
-int main() {
+// ----------------- BATCHED LOOKUPS ----------------------
+// find() one key at a time against findMany() on batches of kLookupBatch keys,
+// half of them present, on trees from cache-sized up to far beyond the LLC
+template<typename TreeType>
+pair<double,double> measureLookups(bench::Suite& suite, const string& name, TreeType& tree,
+                                   int n, const vector<int>& queries) {
+    const size_t kLookupBatch = 4096;
+    const size_t count = queries.size();
+    using Node = remove_pointer_t<decltype(tree.root)>;
+    vector<Node*> seq(count), batched(count);
+
+    auto& rs = suite.run({name + "_find", size_t(n), "sequential", count}, [&]{
+        for (size_t i = 0; i < count; ++i) seq[i] = tree.find(queries[i]);
+        bench::do_not_optimize(seq.data());
+    });
+    auto& rb = suite.run({name + "_find", size_t(n), "batched;group=" + to_string(kFindGroup), count}, [&]{
+        for (size_t i = 0; i < count; i += kLookupBatch)
+            tree.findMany(queries.data() + i, min(kLookupBatch, count - i), batched.data() + i);
+        bench::do_not_optimize(batched.data());
+    });
+    if (seq != batched) cout << name << " n=" << n << ": findMany disagrees with find\n";
+    rb.metric("speedup", rs.stats.median / rb.stats.median);
+    return {rs.stats.median * 1e9, rb.stats.median * 1e9};
+}
+
+void batchedLookupStudy(bench::Suite& suite, int maxN) {
+    const unsigned long long seed = suite.config().seed;
+    mt19937 g(seed);
+    cout << "\nBatched lookups (ns per key):\n";
+    cout << "N\tBinary find/findMany\tAVL find/findMany\n";
+    for (int n : {1 << 16, 1 << 20, 1 << 22}) {
+        if (n > maxN) break;
+        // random insertion order: the BST stays O(log N) deep and its nodes are scattered in memory
+        auto keys = generateKeys(inputgen::Dist::Random, n, seed);
+        const int count = 1 << 19;
+        vector<int> queries(count);
+        uniform_int_distribution<int> key(1, 2 * n);
+        for (int& q : queries) q = key(g);
+
+        BinaryTree bt;
+        for (int k : keys) bt.insert(k);
+        auto [btSeq, btBatched] = measureLookups(suite, "binary", bt, n, queries);
+        AVLTree avl;
+        for (int k : keys) avl.insert(k);
+        auto [avlSeq, avlBatched] = measureLookups(suite, "avl", avl, n, queries);
+
+        cout << n << "\t" << btSeq << "/" << btBatched << "\t\t" << avlSeq << "/" << avlBatched << "\n";
+    }
+}
+
+// Insert timings for one tree type: every distribution, then the perfectly balanced order
+template<typename TreeType>
+void insertStudy(bench::Suite& suite, const string& label, const string& name,
+                 const vector<pair<string, vector<int>>>& inputs, const vector<int>& perfectOrder) {
+    for (const auto& [dist, keys] : inputs) {
+        auto r = measureInsertMedian<TreeType>(suite, name, dist, keys);
+        cout << label << " Insert (" << dist << "): " << r.time << " us, Height: " << r.height
+             << memoryNote(r.memory, keys.size()) << "\n";
+    }
+    auto best = measureInsertMedian<TreeType>(suite, name, "perfect", perfectOrder);
+    cout << label << " Best Insert: " << best.time << " us, Height: " << best.height
+         << memoryNote(best.memory, perfectOrder.size()) << "\n";
+}
+
+int main(int argc, char** argv) {
+    bench::Suite suite("trees", bench::parse_args(argc, argv));
+    // --dist LIST: key orders to insert (default all but antiqsort, which targets sorts).
+    // The order statistics and batched lookups always use random keys: sorted keys
+    // would turn the BinaryTree into a list millions of nodes deep.
+    auto dists = inputgen::parse_args(argc, argv, "random,sorted,reverse,organ_pipe,sawtooth,few_unique,zipf");
+    // optional argument: largest tree for the batched lookups (default 4M nodes)
+    int maxLookupN = argc > 1 ? stoi(argv[1]) : 1 << 22;
+    const unsigned long long seed = suite.config().seed;
     int n = 255;
-    auto keys = generateRandomKeys(n);
-    auto perfectOrder = buildPerfectOrder(keys);
-    int runs = 5;
+
+    vector<pair<string, vector<int>>> inputs;
+    for (auto d : dists) inputs.emplace_back(inputgen::name(d), generateKeys(d, n, seed));
+    auto perfectOrder = buildPerfectOrder(generateKeys(inputgen::Dist::Random, n, seed));
+
+    if (alloc::available())
+        cout << "Node sizes: BinaryNode " << sizeof(BinaryNode) << " B, TernaryNode " << sizeof(TernaryNode)
+             << " B (two keys), AVLNode " << sizeof(AVLNode) << " B\n";
 
     // --- BinaryTree ---
-    auto [btRandomTime, btRandomHeight] = measureInsertMedian<BinaryTree>(keys, runs);
-    auto [btBestTime, btBestHeight] = measureInsertMedian<BinaryTree>(perfectOrder, runs);
-    cout << "BinaryTree Random Insert: " << btRandomTime << " us, Height: " << btRandomHeight << "\n";
-    cout << "BinaryTree Best Insert: " << btBestTime << " us, Height: " << btBestHeight << "\n";
+    insertStudy<BinaryTree>(suite, "BinaryTree", "binary_insert", inputs, perfectOrder);
 
     // --- std::set ---
-    vector<long long> setRandomTimes;
-    for(int i=0;i<runs;i++){
-        set<int> s;
-        auto start = high_resolution_clock::now();
-        for(int k: keys) s.insert(k);
-        auto end = high_resolution_clock::now();
-        setRandomTimes.push_back(duration_cast<microseconds>(end-start).count());
+    for (const auto& [dist, keys] : inputs) {
+        auto& r = suite.run({"set_insert", keys.size(), dist}, [&]{
+            set<int> s;
+            for(int k: keys) s.insert(k);
+            bench::do_not_optimize(s);
+        });
+        cout << "std::set Insert (" << dist << ", median): " << (long long)(r.stats.median * 1e6) << " us"
+             << memoryNote(r.memory, keys.size()) << "\n";
     }
-    cout << "std::set Random Insert (median): " << median(setRandomTimes) << " us\n";
 
     // --- TernaryTree ---
-    auto [ttRandomTime, ttRandomHeight] = measureInsertMedian<TernaryTree>(keys, runs);
-    auto [ttBestTime, ttBestHeight] = measureInsertMedian<TernaryTree>(perfectOrder, runs);
-    cout << "TernaryTree Random Insert: " << ttRandomTime << " us, Height: " << ttRandomHeight << "\n";
-    cout << "TernaryTree Best Insert: " << ttBestTime << " us, Height: " << ttBestHeight << "\n";
+    insertStudy<TernaryTree>(suite, "TernaryTree", "ternary_insert", inputs, perfectOrder);
 
     // --- AVLTree ---
-    auto [avlRandomTime, avlRandomHeight] = measureInsertMedian<AVLTree>(keys, runs);
-    auto [avlBestTime, avlBestHeight] = measureInsertMedian<AVLTree>(perfectOrder, runs);
-    cout << "AVLTree Random Insert: " << avlRandomTime << " us, Height: " << avlRandomHeight << "\n";
-    cout << "AVLTree Best Insert: " << avlBestTime << " us, Height: " << avlBestHeight << "\n";
+    insertStudy<AVLTree>(suite, "AVLTree", "avl_insert", inputs, perfectOrder);
 
+    orderStatisticsStudy(suite);
+    batchedLookupStudy(suite, maxLookupN);
     return 0;
 }
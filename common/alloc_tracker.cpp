@@ -0,0 +1,72 @@
+// Replacement global operator new/delete for BENCH_TRACK_ALLOC builds (see alloc_tracker.h)
+//
+// Every block is prefixed by a header holding the requested size, so delete
+// knows how many bytes it returns without asking the allocator. The header is
+// 16 bytes, or the alignment for over-aligned types, which keeps the returned
+// pointer as aligned as malloc's.
+#include <cstdlib>
+#include <new>
+
+#include "alloc_tracker.h"
+
+namespace {
+
+constexpr std::size_t kHeader = __STDCPP_DEFAULT_NEW_ALIGNMENT__ < 16 ? 16 : __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+std::size_t header_for(std::size_t align) { return align > kHeader ? align : kHeader; }
+
+void* allocate(std::size_t n, std::size_t align) {
+    std::size_t header = header_for(align);
+    std::size_t total = header + (n ? n : 1);
+    void* base;
+    if (align > kHeader) base = std::aligned_alloc(align, (total + align - 1) / align * align);
+    else base = std::malloc(total);
+    if (!base) return nullptr;
+    auto* p = static_cast<unsigned char*>(base) + header;
+    reinterpret_cast<std::size_t*>(p)[-1] = n;
+    alloc::record_alloc(n);
+    return p;
+}
+
+void release(void* p, std::size_t align) {
+    if (!p) return;
+    alloc::record_free(static_cast<std::size_t*>(p)[-1]);
+    std::free(static_cast<unsigned char*>(p) - header_for(align));
+}
+
+void* allocate_or_throw(std::size_t n, std::size_t align) {
+    for (;;) {
+        if (void* p = allocate(n, align)) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+} // namespace
+
+void* operator new(std::size_t n) { return allocate_or_throw(n, 0); }
+void* operator new[](std::size_t n) { return allocate_or_throw(n, 0); }
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept { return allocate(n, 0); }
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept { return allocate(n, 0); }
+void* operator new(std::size_t n, std::align_val_t a) { return allocate_or_throw(n, std::size_t(a)); }
+void* operator new[](std::size_t n, std::align_val_t a) { return allocate_or_throw(n, std::size_t(a)); }
+void* operator new(std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept {
+    return allocate(n, std::size_t(a));
+}
+void* operator new[](std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept {
+    return allocate(n, std::size_t(a));
+}
+
+void operator delete(void* p) noexcept { release(p, 0); }
+void operator delete[](void* p) noexcept { release(p, 0); }
+void operator delete(void* p, std::size_t) noexcept { release(p, 0); }
+void operator delete[](void* p, std::size_t) noexcept { release(p, 0); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { release(p, 0); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { release(p, 0); }
+void operator delete(void* p, std::align_val_t a) noexcept { release(p, std::size_t(a)); }
+void operator delete[](void* p, std::align_val_t a) noexcept { release(p, std::size_t(a)); }
+void operator delete(void* p, std::size_t, std::align_val_t a) noexcept { release(p, std::size_t(a)); }
+void operator delete[](void* p, std::size_t, std::align_val_t a) noexcept { release(p, std::size_t(a)); }
+void operator delete(void* p, std::align_val_t a, const std::nothrow_t&) noexcept { release(p, std::size_t(a)); }
+void operator delete[](void* p, std::align_val_t a, const std::nothrow_t&) noexcept { release(p, std::size_t(a)); }
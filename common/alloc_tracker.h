@@ -0,0 +1,93 @@
+// Heap allocation tracking for the benchmarks (opt-in)
+//
+// Configured with -DBENCH_TRACK_ALLOC=ON, alloc_tracker.cpp is linked into
+// every benchmark and replaces the global operator new/delete. Each block
+// carries a small header with its size, so allocation count, requested bytes
+// and live/peak live bytes are exact. bench::Suite reads them around every
+// timed sample. Without the option nothing is replaced and available() is
+// false; the header only adds the atomics below.
+//
+// Peak resident memory is the kernel's VmHWM, reset for each sample through
+// /proc/self/clear_refs (Linux only, -1 elsewhere).
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace alloc {
+
+struct Counts {
+    std::uint64_t allocs = 0, frees = 0;
+    std::uint64_t bytes = 0;    // requested by every allocation so far
+    std::int64_t live = 0;      // currently allocated
+    std::int64_t peak = 0;      // high-water mark of live since reset_peak()
+};
+
+namespace detail {
+inline std::atomic<std::uint64_t> allocs{0}, frees{0}, bytes{0};
+inline std::atomic<std::int64_t> live{0}, peak{0};
+} // namespace detail
+
+// Called by the replaced operators
+inline void record_alloc(std::size_t n) {
+    using namespace detail;
+    allocs.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(n, std::memory_order_relaxed);
+    std::int64_t now = live.fetch_add(std::int64_t(n), std::memory_order_relaxed) + std::int64_t(n);
+    std::int64_t old = peak.load(std::memory_order_relaxed);
+    while (now > old && !peak.compare_exchange_weak(old, now, std::memory_order_relaxed)) {}
+}
+
+inline void record_free(std::size_t n) {
+    detail::frees.fetch_add(1, std::memory_order_relaxed);
+    detail::live.fetch_sub(std::int64_t(n), std::memory_order_relaxed);
+}
+
+// True when operator new/delete are replaced (built with BENCH_TRACK_ALLOC)
+inline bool available() {
+#ifdef BENCH_TRACK_ALLOC
+    return true;
+#else
+    return false;
+#endif
+}
+
+inline Counts snapshot() {
+    using namespace detail;
+    Counts c;
+    c.allocs = allocs.load(std::memory_order_relaxed);
+    c.frees = frees.load(std::memory_order_relaxed);
+    c.bytes = bytes.load(std::memory_order_relaxed);
+    c.live = live.load(std::memory_order_relaxed);
+    c.peak = peak.load(std::memory_order_relaxed);
+    return c;
+}
+
+// Restarts the high-water mark at the current live size
+inline void reset_peak() { detail::peak.store(detail::live.load(std::memory_order_relaxed), std::memory_order_relaxed); }
+
+// Resident set high-water mark in bytes (VmHWM), -1 if unknown
+inline long long peak_rss() {
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+        if (line.compare(0, 6, "VmHWM:") == 0) return std::stoll(line.substr(6)) * 1024;
+#endif
+    return -1;
+}
+
+// Restarts VmHWM at the current resident size; false if the kernel does not allow it
+inline bool reset_peak_rss() {
+#if defined(__linux__)
+    std::ofstream clear("/proc/self/clear_refs");
+    return bool(clear << "5" << std::flush);
+#else
+    return false;
+#endif
+}
+
+} // namespace alloc
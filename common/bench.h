@@ -0,0 +1,361 @@
+// Shared benchmark harness
+//
+// Every timed case runs an untimed setup, warms up, then repeats until both the
+// repetition count and the time budget are met. Results carry the raw samples
+// plus min/median/mean/p95/stddev and are written as CSV and JSON with one
+// schema for every program:
+//
+//   suite,name,param,n,config,reps,min_s,median_s,mean_s,p95_s,stddev_s,
+//   cycles,instructions,branch_misses,l1d_misses,llc_misses,page_faults,metrics,samples
+//
+// The hardware counter columns are per-operation medians, filled only with
+// --perf and left empty when a counter is unavailable. metrics is
+// "key=value;..." (benchmark-specific counters), samples is "s1;s2;..." in
+// seconds per operation.
+//
+// Builds with BENCH_TRACK_ALLOC also measure the heap around every sample (see
+// alloc_tracker.h) and add the last sample's allocs, alloc_bytes,
+// peak_heap_bytes, bytes_per_elem, leaked_bytes and peak_rss_bytes to metrics.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "alloc_tracker.h"
+#include "perf_counters.h"
+
+// Build configuration recorded with every result (set by the build system)
+#ifndef BENCH_CONFIG
+#define BENCH_CONFIG "default"
+#endif
+
+namespace bench {
+
+using clock = std::chrono::steady_clock;
+
+// ----------------- Optimization barriers -----------------
+#if defined(__GNUC__) || defined(__clang__)
+template <class T>
+inline void do_not_optimize(T const& value) { asm volatile("" : : "r,m"(value) : "memory"); }
+inline void clobber_memory() { asm volatile("" : : : "memory"); }
+#else
+template <class T>
+inline void do_not_optimize(T const& value) {
+    static volatile const void* sink;
+    sink = &value;
+}
+inline void clobber_memory() { std::atomic_signal_fence(std::memory_order_seq_cst); }
+#endif
+
+// ----------------- Configuration -----------------
+struct Config {
+    int warmup = 1;            // untimed runs before sampling
+    int reps = 5;              // minimum number of samples
+    double min_time = 0;       // keep sampling until this many seconds are collected...
+    int max_reps = 1000;       // ...but never take more samples than this
+    std::string out_dir = "."; // where <suite>.csv / <suite>.json go
+    std::string format = "both";  // csv | json | both | none
+    bool perf = false;         // read hardware counters around every sample
+    unsigned long long seed = 1;  // for the programs' input generators
+};
+
+// Consumes the harness flags from argv and leaves the program's own arguments:
+//   --warmup N  --reps N  --min-time SEC  --max-reps N  --out DIR  --format csv|json|both|none  --perf
+//   --seed N
+inline Config parse_args(int& argc, char** argv) {
+    Config cfg;
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (a == "--warmup" && hasValue) cfg.warmup = std::atoi(argv[++i]);
+        else if (a == "--reps" && hasValue) cfg.reps = std::atoi(argv[++i]);
+        else if (a == "--min-time" && hasValue) cfg.min_time = std::atof(argv[++i]);
+        else if (a == "--max-reps" && hasValue) cfg.max_reps = std::atoi(argv[++i]);
+        else if (a == "--out" && hasValue) cfg.out_dir = argv[++i];
+        else if (a == "--format" && hasValue) cfg.format = argv[++i];
+        else if (a == "--perf") cfg.perf = true;
+        else if (a == "--seed" && hasValue) cfg.seed = std::strtoull(argv[++i], nullptr, 10);
+        else argv[kept++] = argv[i];
+    }
+    argc = kept;
+    argv[argc] = nullptr;
+    cfg.reps = std::max(cfg.reps, 1);
+    cfg.max_reps = std::max(cfg.max_reps, cfg.reps);
+    return cfg;
+}
+
+// ----------------- Statistics -----------------
+struct Stats {
+    double min = 0, median = 0, mean = 0, p95 = 0, stddev = 0;
+};
+
+inline Stats summarize(std::vector<double> v) {
+    Stats s;
+    if (v.empty()) return s;
+    std::sort(v.begin(), v.end());
+    std::size_t n = v.size();
+    s.min = v.front();
+    s.median = n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+    s.p95 = v[std::min(n - 1, static_cast<std::size_t>(std::ceil(0.95 * n)) - 1)];  // nearest rank
+    for (double x : v) s.mean += x;
+    s.mean /= n;
+    for (double x : v) s.stddev += (x - s.mean) * (x - s.mean);
+    s.stddev = n > 1 ? std::sqrt(s.stddev / (n - 1)) : 0;
+    return s;
+}
+
+// ----------------- Output -----------------
+// s as a quoted JSON string
+inline std::string json_string(const std::string& s) {
+    std::string out = "\"";
+    for (char ch : s) {
+        switch (ch) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if ((unsigned char)ch < 0x20) {
+                    char hex[8];
+                    std::snprintf(hex, sizeof hex, "\\u%04x", (unsigned char)ch);
+                    out += hex;
+                } else {
+                    out += ch;
+                }
+        }
+    }
+    return out + "\"";
+}
+
+// ----------------- Cases and results -----------------
+struct Case {
+    std::string name;        // what is measured, e.g. "quick_sort_dual"
+    std::size_t n = 0;       // problem size
+    std::string param = "";  // variant on top of name/n, e.g. "leaf=32"
+    std::size_t batch = 1;   // operations per sample; samples are reported per operation
+};
+
+// Heap use of one sample, filled only when allocations are tracked
+struct Memory {
+    bool valid = false;
+    double allocs = 0, bytes = 0;   // allocations and requested bytes per operation
+    double peak_bytes = 0;          // heap high-water mark above the sample's start
+    double leaked_bytes = 0;        // still allocated once the sample's state is destroyed
+    long long peak_rss = -1;        // process VmHWM during the sample, -1 if unknown
+};
+
+struct Result {
+    std::string suite, name, param, config;
+    std::size_t n = 0;
+    std::vector<double> samples;
+    Stats stats;
+    perf::Reading counters;  // per-operation medians
+    Memory memory;           // last sample
+    std::vector<std::pair<std::string, double>> metrics;
+
+    void metric(const std::string& key, double value) { metrics.emplace_back(key, value); }
+};
+
+class Suite {
+public:
+    Suite(std::string name, Config cfg) : name_(std::move(name)), cfg_(std::move(cfg)) {
+        if (!cfg_.perf) return;
+        counters_ = std::make_unique<perf::Counters>();
+        if (!counters_->available())
+            std::cerr << "[bench] perf counters unavailable, reporting time only" << std::endl;
+    }
+    ~Suite() { write(); }
+
+    const Config& config() const { return cfg_; }
+    const std::deque<Result>& results() const { return results_; }
+
+    // setup() runs untimed before every sample; fn(state) is timed
+    template <class Setup, class Fn>
+    Result& run(const Case& c, Setup setup, Fn fn) {
+        for (int i = 0; i < cfg_.warmup; ++i) {
+            auto state = setup();
+            fn(state);
+            do_not_optimize(state);
+        }
+
+        Result r;
+        r.suite = name_;
+        r.name = c.name;
+        r.param = c.param;
+        r.config = BENCH_CONFIG;
+        r.n = c.n;
+        double total = 0;
+        std::vector<double> events[perf::kEventCount];
+        const bool track = alloc::available();
+        while ((int)r.samples.size() < cfg_.reps ||
+               (total < cfg_.min_time && (int)r.samples.size() < cfg_.max_reps)) {
+            perf::Reading reading;
+            alloc::Counts before, after;
+            std::int64_t liveBefore = track ? alloc::snapshot().live : 0;
+            clock::time_point start, end;
+            {
+                auto state = setup();
+                if (track) {
+                    alloc::reset_peak_rss();
+                    alloc::reset_peak();
+                    before = alloc::snapshot();
+                }
+                clobber_memory();
+                if (counters_) counters_->start();
+                start = clock::now();
+                fn(state);
+                do_not_optimize(state);
+                clobber_memory();
+                end = clock::now();
+                if (counters_) reading = counters_->stop();
+                if (track) after = alloc::snapshot();
+            }
+            if (track) {
+                Memory& m = r.memory;
+                m.valid = true;
+                m.allocs = double(after.allocs - before.allocs) / c.batch;
+                m.bytes = double(after.bytes - before.bytes) / c.batch;
+                m.peak_bytes = double(after.peak - before.live);
+                m.leaked_bytes = double(alloc::snapshot().live - liveBefore);
+                m.peak_rss = alloc::peak_rss();
+            }
+            for (int e = 0; e < perf::kEventCount; ++e)
+                if (reading.valid[e]) events[e].push_back(reading.value[e] / c.batch);
+            double secs = std::chrono::duration<double>(end - start).count();
+            total += secs;
+            r.samples.push_back(secs / c.batch);
+        }
+        r.stats = summarize(r.samples);
+        for (int e = 0; e < perf::kEventCount; ++e) {
+            // only report counters that were read for every sample
+            r.counters.valid[e] = events[e].size() == r.samples.size();
+            if (r.counters.valid[e]) r.counters.value[e] = summarize(events[e]).median;
+        }
+        if (r.memory.valid) {
+            const Memory& m = r.memory;
+            r.metric("allocs", m.allocs);
+            r.metric("alloc_bytes", m.bytes);
+            r.metric("peak_heap_bytes", m.peak_bytes);
+            if (r.n) r.metric("bytes_per_elem", m.peak_bytes / r.n);
+            r.metric("leaked_bytes", m.leaked_bytes);
+            if (m.peak_rss >= 0) r.metric("peak_rss_bytes", double(m.peak_rss));
+        }
+        results_.push_back(std::move(r));
+        if (counters_ && counters_->available()) print_counters(results_.back());
+        if (results_.back().memory.valid) print_memory(results_.back());
+        return results_.back();
+    }
+
+    template <class Fn>
+    Result& run(const Case& c, Fn fn) {
+        return run(c, [] { return 0; }, [&](int&) { fn(); });
+    }
+
+    // Writes <out_dir>/<suite>.csv and/or .json; called again by the destructor
+    void write() {
+        if (written_ == results_.size()) return;
+        written_ = results_.size();
+        if (cfg_.format == "csv" || cfg_.format == "both") write_csv(cfg_.out_dir + "/" + name_ + ".csv");
+        if (cfg_.format == "json" || cfg_.format == "both") write_json(cfg_.out_dir + "/" + name_ + ".json");
+    }
+
+    void write_csv(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out.is_open()) { std::cerr << "Error writing " << path << std::endl; return; }
+        out.precision(9);
+        out << "suite,name,param,n,config,reps,min_s,median_s,mean_s,p95_s,stddev_s,";
+        for (int e = 0; e < perf::kEventCount; ++e) out << perf::event_name(e) << ",";
+        out << "metrics,samples\n";
+        for (const auto& r : results_) {
+            out << r.suite << "," << r.name << "," << r.param << "," << r.n << "," << r.config << ","
+                << r.samples.size() << "," << r.stats.min << "," << r.stats.median << ","
+                << r.stats.mean << "," << r.stats.p95 << "," << r.stats.stddev << ",";
+            for (int e = 0; e < perf::kEventCount; ++e) {
+                if (r.counters.valid[e]) out << r.counters.value[e];
+                out << ",";
+            }
+            for (std::size_t i = 0; i < r.metrics.size(); ++i)
+                out << (i ? ";" : "") << r.metrics[i].first << "=" << r.metrics[i].second;
+            out << ",";
+            for (std::size_t i = 0; i < r.samples.size(); ++i)
+                out << (i ? ";" : "") << r.samples[i];
+            out << "\n";
+        }
+    }
+
+    void write_json(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out.is_open()) { std::cerr << "Error writing " << path << std::endl; return; }
+        out.precision(9);
+        out << "[\n";
+        for (std::size_t k = 0; k < results_.size(); ++k) {
+            const auto& r = results_[k];
+            out << "  {\"suite\": " << json_string(r.suite) << ", \"name\": " << json_string(r.name)
+                << ", \"param\": " << json_string(r.param) << ", \"n\": " << r.n
+                << ", \"config\": " << json_string(r.config) << ", \"reps\": " << r.samples.size()
+                << ", \"min_s\": " << r.stats.min << ", \"median_s\": " << r.stats.median
+                << ", \"mean_s\": " << r.stats.mean << ", \"p95_s\": " << r.stats.p95
+                << ", \"stddev_s\": " << r.stats.stddev << ", \"counters\": {";
+            for (int e = 0; e < perf::kEventCount; ++e) {
+                out << (e ? ", " : "") << "\"" << perf::event_name(e) << "\": ";
+                if (r.counters.valid[e]) out << r.counters.value[e];
+                else out << "null";
+            }
+            out << "}, \"metrics\": {";
+            for (std::size_t i = 0; i < r.metrics.size(); ++i)
+                out << (i ? ", " : "") << json_string(r.metrics[i].first) << ": " << r.metrics[i].second;
+            out << "}, \"samples\": [";
+            for (std::size_t i = 0; i < r.samples.size(); ++i)
+                out << (i ? ", " : "") << r.samples[i];
+            out << "]}" << (k + 1 < results_.size() ? "," : "") << "\n";
+        }
+        out << "]\n";
+    }
+
+private:
+    // One line per case next to the program's own timing output
+    static void print_counters(const Result& r) {
+        std::ostringstream line;  // own stream: the program's cout formatting stays untouched
+        line << "  [perf] " << r.name << (r.param.empty() ? "" : " " + r.param) << " n=" << r.n << ":";
+        for (int e = 0; e < perf::kEventCount; ++e)
+            if (r.counters.valid[e]) line << " " << perf::event_name(e) << "=" << r.counters.value[e];
+        const auto& c = r.counters;
+        if (c.valid[perf::Cycles] && c.valid[perf::Instructions] && c.value[perf::Cycles] > 0)
+            line << " ipc=" << c.value[perf::Instructions] / c.value[perf::Cycles];
+        std::cout << line.str() << std::endl;
+    }
+
+    static void print_memory(const Result& r) {
+        const Memory& m = r.memory;
+        std::ostringstream line;
+        line << "  [alloc] " << r.name << (r.param.empty() ? "" : " " + r.param) << " n=" << r.n << ":"
+             << " allocs=" << (long long)m.allocs << " bytes=" << (long long)m.bytes
+             << " peak_heap=" << (long long)m.peak_bytes;
+        if (r.n) line << " bytes_per_elem=" << m.peak_bytes / r.n;
+        line << " leaked=" << (long long)m.leaked_bytes;
+        if (m.peak_rss >= 0) line << " peak_rss=" << m.peak_rss;
+        std::cout << line.str() << std::endl;
+    }
+
+    std::string name_;
+    Config cfg_;
+    std::unique_ptr<perf::Counters> counters_;
+    std::deque<Result> results_;  // deque: references returned by run() stay valid
+    std::size_t written_ = 0;
+};
+
+} // namespace bench
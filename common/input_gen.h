@@ -0,0 +1,154 @@
+// Seeded input distributions for the sort and tree benchmarks
+//
+// Every distribution yields n ints in [0, n), and the same (distribution, n,
+// seed) always gives the same array:
+//
+//   random      a random permutation
+//   sorted      0, 1, ..., n-1
+//   reverse     n-1, ..., 1, 0
+//   organ_pipe  ascending to the middle, then descending
+//   sawtooth    8 ascending runs
+//   few_unique  16 distinct values, random order
+//   zipf        Zipf(1) ranks: a few values make up most of the array
+//   antiqsort   McIlroy's adversary against a given comparison sort
+//
+// antiqsort ("A Killer Adversary for Quicksort", 1999) runs the target sort on
+// a "gas" comparator that fixes element values only when the sort compares
+// them, always in the way that makes the sort's current pivot look bad. The
+// values it ends up with are an input on which that sort degrades, e.g. to
+// O(n^2) for a quicksort with a fixed pivot rule.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace inputgen {
+
+enum class Dist { Random, Sorted, Reverse, OrganPipe, Sawtooth, FewUnique, Zipf, AntiQsort };
+
+inline const std::vector<Dist>& all() {
+    static const std::vector<Dist> dists = {Dist::Random, Dist::Sorted, Dist::Reverse, Dist::OrganPipe,
+                                            Dist::Sawtooth, Dist::FewUnique, Dist::Zipf, Dist::AntiQsort};
+    return dists;
+}
+
+inline const char* name(Dist d) {
+    switch (d) {
+        case Dist::Random:    return "random";
+        case Dist::Sorted:    return "sorted";
+        case Dist::Reverse:   return "reverse";
+        case Dist::OrganPipe: return "organ_pipe";
+        case Dist::Sawtooth:  return "sawtooth";
+        case Dist::FewUnique: return "few_unique";
+        case Dist::Zipf:      return "zipf";
+        case Dist::AntiQsort: return "antiqsort";
+    }
+    return "?";
+}
+
+// Distributions named in a comma-separated list ("all" = every one); unknown names are skipped
+inline std::vector<Dist> parse_list(const std::string& list) {
+    if (list == "all") return all();
+    std::vector<Dist> out;
+    std::size_t start = 0;
+    while (start <= list.size()) {
+        std::size_t end = std::min(list.find(',', start), list.size());
+        std::string item = list.substr(start, end - start);
+        for (Dist d : all())
+            if (item == name(d)) out.push_back(d);
+        start = end + 1;
+    }
+    return out;
+}
+
+// Consumes "--dist LIST" from argv like bench::parse_args; without it, fallback
+inline std::vector<Dist> parse_args(int& argc, char** argv, const std::string& fallback = "all") {
+    std::string list = fallback;
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--dist" && i + 1 < argc) list = argv[++i];
+        else argv[kept++] = argv[i];
+    }
+    argc = kept;
+    argv[argc] = nullptr;
+    return parse_list(list);
+}
+
+// McIlroy's adversary. sort(idx, less) must sort the index vector idx with
+// the comparator less(int, int); the result is the input that fooled it.
+template <class Sort>
+std::vector<int> antiqsort(std::size_t n, Sort sort) {
+    const int gas = int(n);  // not yet decided: larger than every solid value
+    std::vector<int> val(n, gas), idx(n);
+    std::iota(idx.begin(), idx.end(), 0);
+    int solid = 0;
+    int candidate = 0;  // the gas element most likely to be the pivot
+    auto less = [&](int x, int y) {
+        if (val[x] == gas && val[y] == gas) {
+            if (x == candidate) val[x] = solid++;
+            else val[y] = solid++;
+        }
+        if (val[x] == gas) candidate = x;
+        else if (val[y] == gas) candidate = y;
+        return val[x] < val[y];
+    };
+    sort(idx, less);
+    for (int& v : val)
+        if (v == gas) v = solid++;
+    return val;
+}
+
+// Everything but antiqsort; antiqsort without a target attacks std::sort
+inline std::vector<int> generate(Dist d, std::size_t n, std::uint64_t seed) {
+    std::vector<int> a(n);
+    std::mt19937_64 gen(seed);
+    switch (d) {
+        case Dist::Random:
+            std::iota(a.begin(), a.end(), 0);
+            std::shuffle(a.begin(), a.end(), gen);
+            break;
+        case Dist::Sorted:
+            std::iota(a.begin(), a.end(), 0);
+            break;
+        case Dist::Reverse:
+            for (std::size_t i = 0; i < n; ++i) a[i] = int(n - 1 - i);
+            break;
+        case Dist::OrganPipe:
+            for (std::size_t i = 0; i < n; ++i) a[i] = int(2 * std::min(i, n - 1 - i));
+            break;
+        case Dist::Sawtooth: {
+            std::size_t period = std::max<std::size_t>(1, (n + 7) / 8);
+            for (std::size_t i = 0; i < n; ++i) a[i] = int(i % period * n / period);
+            break;
+        }
+        case Dist::FewUnique: {
+            std::uniform_int_distribution<int> value(0, 15);
+            for (int& x : a) x = value(gen) * int(std::max<std::size_t>(1, n / 16));
+            break;
+        }
+        case Dist::Zipf: {
+            // inverse of the continuous 1/x density on [1, n + 1)
+            std::uniform_real_distribution<double> u(0.0, 1.0);
+            double logN = std::log(double(n) + 1);
+            for (int& x : a) x = std::min(int(n) - 1, int(std::exp(u(gen) * logN)) - 1);
+            break;
+        }
+        case Dist::AntiQsort:
+            return antiqsort(n, [](std::vector<int>& v, auto less) { std::sort(v.begin(), v.end(), less); });
+    }
+    return a;
+}
+
+// As generate(), with the antiqsort adversary aimed at target (see antiqsort)
+template <class Sort>
+std::vector<int> generate(Dist d, std::size_t n, std::uint64_t seed, Sort target) {
+    return d == Dist::AntiQsort ? antiqsort(n, target) : generate(d, n, seed);
+}
+
+} // namespace inputgen
@@ -0,0 +1,115 @@
+// Hardware performance counters around a timed region (Linux perf_event_open)
+//
+// Each event is opened on its own, so one unsupported counter does not take the
+// others down. Events that cannot be opened (no PMU in a VM or container,
+// perf_event_paranoid, non-Linux builds) are reported as unavailable.
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace perf {
+
+enum Event { Cycles, Instructions, BranchMisses, L1DMisses, LLCMisses, PageFaults, kEventCount };
+
+// Column names, in Event order
+inline const char* event_name(int e) {
+    static const char* names[kEventCount] = {
+        "cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses", "page_faults"};
+    return names[e];
+}
+
+struct Reading {
+    std::array<bool, kEventCount> valid{};
+    std::array<double, kEventCount> value{};
+};
+
+class Counters {
+public:
+    Counters() {
+        fds_.fill(-1);
+#if defined(__linux__)
+        using C = std::uint64_t;
+        auto cache = [](C cache, C op, C result) { return cache | (op << 8) | (result << 16); };
+        open(Cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        open(Instructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        open(BranchMisses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        open(L1DMisses, PERF_TYPE_HW_CACHE,
+             cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS));
+        open(LLCMisses, PERF_TYPE_HW_CACHE,
+             cache(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS));
+        open(PageFaults, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+#endif
+    }
+
+    ~Counters() {
+#if defined(__linux__)
+        for (int fd : fds_)
+            if (fd >= 0) close(fd);
+#endif
+    }
+
+    Counters(const Counters&) = delete;
+    Counters& operator=(const Counters&) = delete;
+
+    bool available() const {
+        for (int fd : fds_)
+            if (fd >= 0) return true;
+        return false;
+    }
+
+    void start() {
+#if defined(__linux__)
+        for (int fd : fds_)
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+    }
+
+    Reading stop() {
+        Reading r;
+#if defined(__linux__)
+        for (int fd : fds_)
+            if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        for (int e = 0; e < kEventCount; ++e) {
+            if (fds_[e] < 0) continue;
+            std::uint64_t buf[3];  // value, time enabled, time running
+            if (read(fds_[e], buf, sizeof(buf)) != sizeof(buf) || buf[2] == 0) continue;
+            // scale up if the kernel multiplexed this counter
+            r.value[e] = buf[1] == buf[2] ? double(buf[0]) : double(buf[0]) * double(buf[1]) / double(buf[2]);
+            r.valid[e] = true;
+        }
+#endif
+        return r;
+    }
+
+private:
+    std::array<int, kEventCount> fds_;
+
+#if defined(__linux__)
+    void open(Event e, std::uint32_t type, std::uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;  // user space only: allowed up to perf_event_paranoid = 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        fds_[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+#endif
+};
+
+} // namespace perf
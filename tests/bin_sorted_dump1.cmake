@@ -0,0 +1,31 @@
+# olsen_gang --bin must give the CSV path's result when carddump1.bin was
+# written with csv2bin --sort: dump1 is joined in CSV row order.
+#
+#   cmake -DGEN=... -DCONVERT=... -DOLSEN=... -DWORK=<dir> -P bin_sorted_dump1.cmake
+#
+# dump2 doubles as dump1 so that dump1's rows carry (year, month, PIN) keys
+# and --sort really moves them.
+
+function(run)
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE rc OUTPUT_QUIET)
+    if(NOT rc EQUAL 0)
+        message(FATAL_ERROR "failed (${rc}): ${ARGN}")
+    endif()
+endfunction()
+
+file(REMOVE_RECURSE ${WORK})
+file(MAKE_DIRECTORY ${WORK})
+run(${GEN} 5000 ${WORK} --seed 9)
+file(COPY_FILE ${WORK}/carddump2.csv ${WORK}/carddump1.csv)
+
+run(${OLSEN} --data ${WORK} --reps 1 --warmup 0 --format none)
+file(RENAME ${WORK}/carddump_sorted_full.csv ${WORK}/expected.csv)
+
+run(${CONVERT} csv2bin ${WORK}/carddump1.csv ${WORK}/carddump1.bin --sort)
+run(${OLSEN} --data ${WORK} --bin --reps 1 --warmup 0 --format none)
+
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${WORK}/expected.csv ${WORK}/carddump_sorted_full.csv
+                RESULT_VARIABLE differ)
+if(differ)
+    message(FATAL_ERROR "--bin with a sorted carddump1.bin differs from the CSV merge")
+endif()
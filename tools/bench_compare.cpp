@@ -0,0 +1,253 @@
+// Benchmark results store and regression check
+//
+//   bench_compare record  <results_dir> <store_dir> [--baseline]
+//       copies every <suite>.csv into <store>/<config>/runs/<timestamp>/,
+//       and with --baseline also into <store>/<config>/baseline/
+//   bench_compare check   <results_dir> <store_dir> [--alpha A] [--threshold T]
+//       compares each result with the stored baseline of its build config
+//   bench_compare compare <baseline_dir> <results_dir> [--alpha A] [--threshold T]
+//       compares two result directories directly, matching cases across build
+//       configs (e.g. Release against native or PGO)
+//
+// A case (suite, name, param, n, config) regresses when a one-sided
+// Mann-Whitney U test on the samples says the new run is slower (p < alpha)
+// and its median is more than threshold slower. Exit code: 0 clean,
+// 1 regression found, 2 usage or I/O error.
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <filesystem>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// ----------------- Results -----------------
+struct Row {
+    string key;      // suite/name/param/n
+    string config;
+    vector<double> samples;
+    double median = 0;
+};
+
+vector<string> split(const string& s, char sep) {
+    vector<string> out;
+    string cur;
+    stringstream ss(s);
+    while (getline(ss, cur, sep)) out.push_back(cur);
+    if (!s.empty() && s.back() == sep) out.push_back("");
+    return out;
+}
+
+double median_of(vector<double> v) {
+    if (v.empty()) return 0;
+    sort(v.begin(), v.end());
+    size_t n = v.size();
+    return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+// Reads one harness CSV; columns are looked up by name so older files still load
+vector<Row> read_results(const fs::path& path) {
+    vector<Row> rows;
+    ifstream in(path);
+    string line;
+    if (!getline(in, line)) return rows;
+    map<string, size_t> col;
+    auto header = split(line, ',');
+    for (size_t i = 0; i < header.size(); ++i) col[header[i]] = i;
+    for (const char* c : {"suite", "name", "param", "n", "config", "samples"})
+        if (!col.count(c)) { cerr << "Skipping " << path << ": no '" << c << "' column\n"; return rows; }
+
+    while (getline(in, line)) {
+        auto f = split(line, ',');
+        if (f.size() < header.size()) continue;
+        Row r;
+        r.key = f[col["suite"]] + "/" + f[col["name"]] + "/" + f[col["param"]] + "/" + f[col["n"]];
+        r.config = f[col["config"]];
+        for (const auto& s : split(f[col["samples"]], ';'))
+            if (!s.empty()) r.samples.push_back(stod(s));
+        r.median = median_of(r.samples);
+        rows.push_back(r);
+    }
+    return rows;
+}
+
+vector<Row> read_dir(const fs::path& dir) {
+    vector<Row> rows;
+    if (!fs::is_directory(dir)) return rows;
+    for (const auto& e : fs::directory_iterator(dir))
+        if (e.path().extension() == ".csv") {
+            auto part = read_results(e.path());
+            rows.insert(rows.end(), part.begin(), part.end());
+        }
+    return rows;
+}
+
+// ----------------- Mann-Whitney U -----------------
+double normal_cdf(double z) { return 0.5 * erfc(-z / sqrt(2.0)); }
+
+// One-sided p-value for "b is stochastically larger than a"
+double mann_whitney_greater(const vector<double>& a, const vector<double>& b) {
+    size_t n1 = a.size(), n2 = b.size();
+    if (n1 == 0 || n2 == 0) return 1;
+
+    // midranks of the pooled samples
+    vector<pair<double,int>> pooled;
+    for (double x : a) pooled.push_back({x, 0});
+    for (double x : b) pooled.push_back({x, 1});
+    sort(pooled.begin(), pooled.end());
+    size_t N = pooled.size();
+    double rankSumB = 0, tieTerm = 0;
+    bool ties = false;
+    for (size_t i = 0; i < N;) {
+        size_t j = i;
+        while (j < N && pooled[j].first == pooled[i].first) ++j;
+        double rank = (i + 1 + j) / 2.0;
+        for (size_t k = i; k < j; ++k)
+            if (pooled[k].second == 1) rankSumB += rank;
+        double t = double(j - i);
+        if (t > 1) { ties = true; tieTerm += t * t * t - t; }
+        i = j;
+    }
+    double U = rankSumB - n2 * (n2 + 1) / 2.0;  // pairs where b beats a
+
+    if (!ties && n1 <= 20 && n2 <= 20) {
+        // exact null distribution: cnt[i][j][u] = arrangements of i a's and j b's with U = u
+        size_t maxU = n1 * n2;
+        vector<vector<vector<double>>> cnt(n1 + 1, vector<vector<double>>(n2 + 1, vector<double>(maxU + 1, 0)));
+        for (size_t i = 0; i <= n1; ++i)
+            for (size_t j = 0; j <= n2; ++j) {
+                if (i == 0 || j == 0) { cnt[i][j][0] = 1; continue; }
+                for (size_t u = 0; u <= i * j; ++u) {
+                    // largest element is a b (beats all i a's) or an a
+                    double v = cnt[i - 1][j][u];
+                    if (u >= i) v += cnt[i][j - 1][u - i];
+                    cnt[i][j][u] = v;
+                }
+            }
+        double total = 0, tail = 0;
+        for (size_t u = 0; u <= maxU; ++u) {
+            total += cnt[n1][n2][u];
+            if (u + 1e-9 >= U) tail += cnt[n1][n2][u];
+        }
+        return tail / total;
+    }
+
+    double mean = n1 * n2 / 2.0;
+    double var = n1 * n2 / 12.0 * ((N + 1) - tieTerm / (double(N) * (N - 1)));
+    if (var <= 0) return 1;
+    double z = (U - mean - 0.5) / sqrt(var);  // continuity correction
+    return 1 - normal_cdf(z);
+}
+
+// ----------------- Commands -----------------
+struct Thresholds {
+    double alpha = 0.01;       // significance level
+    double threshold = 0.05;   // minimum relative slowdown of the median
+};
+
+// acrossConfigs matches cases on their key alone, so two build configs can be compared
+int compare(const vector<Row>& baseline, const vector<Row>& current, const Thresholds& th, bool acrossConfigs = false) {
+    auto match = [&](const Row& r) { return acrossConfigs ? r.key : r.config + "|" + r.key; };
+    map<string, const Row*> base;
+    for (const auto& r : baseline) base[match(r)] = &r;
+
+    int regressions = 0, matched = 0;
+    cout << left;
+    for (const auto& r : current) {
+        auto it = base.find(match(r));
+        if (it == base.end()) continue;
+        const Row& b = *it->second;
+        ++matched;
+        double ratio = b.median > 0 ? r.median / b.median : 1;
+        double pSlower = mann_whitney_greater(b.samples, r.samples);
+        double pFaster = mann_whitney_greater(r.samples, b.samples);
+        bool slower = pSlower < th.alpha && ratio > 1 + th.threshold;
+        bool faster = pFaster < th.alpha && ratio < 1 - th.threshold;
+        if (slower) ++regressions;
+        if (slower || faster)
+            cout << (slower ? "REGRESSION  " : "improvement ")
+                 << (b.config == r.config ? r.config : b.config + " -> " + r.config) << " " << r.key
+                 << "  median " << b.median << " -> " << r.median << " s"
+                 << "  (x" << ratio << ", p=" << (slower ? pSlower : pFaster) << ")\n";
+    }
+    cout << matched << " cases compared, " << regressions << " regression(s)\n";
+    if (matched == 0) cerr << "No matching cases: is the baseline from the same build config?\n";
+    return regressions ? 1 : 0;
+}
+
+int record(const fs::path& results, const fs::path& store, bool asBaseline) {
+    time_t now = time(nullptr);
+    char stamp[32];
+    strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", localtime(&now));
+
+    int files = 0;
+    for (const auto& e : fs::directory_iterator(results)) {
+        if (e.path().extension() != ".csv") continue;
+        auto rows = read_results(e.path());
+        if (rows.empty()) continue;
+        fs::path configDir = store / rows.front().config;
+        vector<fs::path> targets = {configDir / "runs" / stamp};
+        if (asBaseline) targets.push_back(configDir / "baseline");
+        for (const auto& dir : targets) {
+            fs::create_directories(dir);
+            fs::copy_file(e.path(), dir / e.path().filename(), fs::copy_options::overwrite_existing);
+        }
+        ++files;
+    }
+    cout << "Recorded " << files << " result file(s) from " << results << " into " << store
+         << (asBaseline ? " (baseline)" : "") << "\n";
+    return files ? 0 : 2;
+}
+
+int check(const fs::path& results, const fs::path& store, const Thresholds& th) {
+    auto current = read_dir(results);
+    vector<string> configs;
+    for (const auto& r : current)
+        if (find(configs.begin(), configs.end(), r.config) == configs.end()) configs.push_back(r.config);
+
+    vector<Row> baseline;
+    for (const auto& c : configs) {
+        auto part = read_dir(store / c / "baseline");
+        if (part.empty()) cerr << "No baseline for config " << c << " in " << store << "\n";
+        baseline.insert(baseline.end(), part.begin(), part.end());
+    }
+    return compare(baseline, current, th);
+}
+
+int usage() {
+    cerr << "usage: bench_compare record  <results_dir> <store_dir> [--baseline]\n"
+            "       bench_compare check   <results_dir> <store_dir> [--alpha A] [--threshold T]\n"
+            "       bench_compare compare <baseline_dir> <results_dir> [--alpha A] [--threshold T]\n";
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    vector<string> args(argv + 1, argv + argc);
+    Thresholds th;
+    bool asBaseline = false;
+    vector<string> pos;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--alpha" && i + 1 < args.size()) th.alpha = stod(args[++i]);
+        else if (args[i] == "--threshold" && i + 1 < args.size()) th.threshold = stod(args[++i]);
+        else if (args[i] == "--baseline") asBaseline = true;
+        else pos.push_back(args[i]);
+    }
+    if (pos.size() != 3) return usage();
+    if (!fs::is_directory(pos[1])) { cerr << "Not a directory: " << pos[1] << "\n"; return 2; }
+
+    if (pos[0] == "record") return record(pos[1], pos[2], asBaseline);
+    if (pos[0] == "check") return check(pos[1], pos[2], th);
+    if (pos[0] == "compare") {
+        auto baseline = read_dir(pos[1]), current = read_dir(pos[2]);
+        if (!baseline.empty() && !current.empty() && baseline.front().config != current.front().config)
+            cout << "Comparing config " << baseline.front().config << " -> " << current.front().config << "\n";
+        return compare(baseline, current, th, true);
+    }
+    return usage();
+}